@@ -0,0 +1,241 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2018 PohSeng#1.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   Arena.h
+ * Author: Matthias Ngeo - S10172190F
+ * Author: Francis Koh - S10172072G
+ *
+ * Created on February 8, 2018, 3:10 PM
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace assignment {
+
+    /**
+     * Represents a region of memory from which objects are allocated consecutively, so that objects
+     * which are allocated one after another are adjacent in memory. Memory is only freed when the arena
+     * is destroyed.
+     *
+     * An arena counts its references, which consist of the allocations which have not been deallocated
+     * and the references acquired by its owner, and destroys itself once the count reaches 0.
+     */
+    class Arena {
+        private:
+            vector<pair<char*, size_t>> blocks;
+            char* position;
+            char* end;
+            size_t capacity;
+            atomic<int> references;
+            
+            /**
+             * Frees all blocks. Arenas are destroyed using #release().
+             */
+            ~Arena();
+        
+        public:
+            /**
+             * Constructs an Arena with a single reference, which allocates blocks of at least the specified
+             * size in bytes.
+             *
+             * @param capacity the size of a block
+             */
+            Arena(size_t capacity);
+            
+            Arena(const Arena& other) = delete;
+            
+            Arena& operator=(const Arena& other) = delete;
+            
+            /**
+             * Allocates the specified number of bytes with the specified alignment after the previous
+             * allocation, or at the start of a new block if the current block has no room.
+             *
+             * @param bytes the number of bytes
+             * @param alignment the alignment, which is at most the alignment of max_align_t
+             * @return the allocated memory
+             */
+            void* allocate(size_t bytes, size_t alignment);
+            
+            /**
+             * Adds a reference to the arena.
+             */
+            void acquire();
+            
+            /**
+             * Removes a reference to the arena, and destroys the arena if no references remain.
+             */
+            void release();
+            
+            /**
+             * Returns whether the specified memory was allocated from the arena.
+             *
+             * @param pointer the memory
+             * @return true if the memory lies within a block of the arena; else false
+             */
+            bool contains(const void* pointer) const;
+    };
+
+
+    /**
+     * Represents an allocator which allocates from an Arena, and holds a reference to the arena for each
+     * allocation which has not been deallocated. Used with allocate_shared, so that the nodes of a tree are
+     * adjacent in memory while still being owned by shared_ptrs.
+     */
+    template <class T>
+    class ArenaAllocator {
+        template <class U>
+        friend class ArenaAllocator;
+        
+        private:
+            Arena* arena;
+        
+        public:
+            using value_type = T;
+            
+            /**
+             * Constructs an ArenaAllocator which allocates from the specified arena.
+             *
+             * @param arena the arena
+             */
+            ArenaAllocator(Arena* arena) noexcept;
+            
+            /**
+             * Constructs an ArenaAllocator which allocates from the same arena as the specified allocator.
+             *
+             * @param other the allocator
+             */
+            template <class U>
+            ArenaAllocator(const ArenaAllocator<U>& other) noexcept;
+            
+            /**
+             * Allocates memory for the specified number of objects.
+             *
+             * @param count the number of objects
+             * @return the allocated memory
+             */
+            T* allocate(size_t count);
+            
+            /**
+             * Deallocates the specified memory, which releases the reference to the arena held by the allocation.
+             *
+             * @param pointer the memory
+             * @param count the number of objects
+             */
+            void deallocate(T* pointer, size_t count) noexcept;
+            
+            template <class U>
+            bool operator==(const ArenaAllocator<U>& other) const noexcept;
+            
+            template <class U>
+            bool operator!=(const ArenaAllocator<U>& other) const noexcept;
+    };
+
+    inline Arena::Arena(size_t capacity) : position(nullptr), end(nullptr), capacity(max(capacity, (size_t) 4096)), references(1) {}
+
+    inline Arena::~Arena() {
+        for (auto& block : blocks) {
+            ::operator delete(block.first);
+        }
+    }
+
+    inline void* Arena::allocate(size_t bytes, size_t alignment) {
+        auto address = (reinterpret_cast<uintptr_t>(position) + alignment - 1) & ~(uintptr_t) (alignment - 1);
+        if (!position || address + bytes > reinterpret_cast<uintptr_t>(end)) {
+            auto size = max(capacity, bytes);
+            blocks.push_back(make_pair(static_cast<char*>(::operator new(size)), size));
+            position = blocks.back().first;
+            end = position + size;
+            address = reinterpret_cast<uintptr_t>(position);
+        }
+        
+        position = reinterpret_cast<char*>(address + bytes);
+        return reinterpret_cast<void*>(address);
+    }
+
+    inline void Arena::acquire() {
+        references++;
+    }
+
+    inline void Arena::release() {
+        if (--references == 0) {
+            delete this;
+        }
+    }
+
+    inline bool Arena::contains(const void* pointer) const {
+        auto address = static_cast<const char*>(pointer);
+        for (auto& block : blocks) {
+            if (block.first <= address && address < block.first + block.second) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <class T>
+    ArenaAllocator<T>::ArenaAllocator(Arena* arena) noexcept : arena(arena) {}
+
+    template <class T>
+    template <class U>
+    ArenaAllocator<T>::ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
+
+    template <class T>
+    T* ArenaAllocator<T>::allocate(size_t count) {
+        auto memory = arena->allocate(count * sizeof(T), alignof(T));
+        arena->acquire();
+        return static_cast<T*>(memory);
+    }
+
+    template <class T>
+    void ArenaAllocator<T>::deallocate(T*, size_t) noexcept {
+        arena->release();
+    }
+
+    template <class T>
+    template <class U>
+    bool ArenaAllocator<T>::operator==(const ArenaAllocator<U>& other) const noexcept {
+        return arena == other.arena;
+    }
+
+    template <class T>
+    template <class U>
+    bool ArenaAllocator<T>::operator!=(const ArenaAllocator<U>& other) const noexcept {
+        return arena != other.arena;
+    }
+
+}
+
+#endif /* ARENA_H */
@@ -0,0 +1,229 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2018 PohSeng#1.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   Augment.h
+ * Author: Matthias Ngeo - S10172190F
+ * Author: Francis Koh - S10172072G
+ *
+ * Created on January 26, 2018, 7:40 PM
+ */
+
+#ifndef AUGMENT_H
+#define AUGMENT_H
+
+#include <limits>
+#include <memory>
+
+#include "Node.h"
+
+using namespace std;
+
+namespace assignment {
+
+    /*
+     * An augmentation is a monoid which is used to keep an aggregate of each subtree in its root node.
+     *
+     * An augmentation provides the following:
+     *
+     * type
+     *      the type of the aggregate.
+     *
+     * identity()
+     *      returns the aggregate of an empty subtree.
+     *
+     * of(const T& value, int amount)
+     *      returns the aggregate of a single node with the specified value and amount.
+     *
+     * combine(const type& left, const type& right)
+     *      returns the aggregate of two adjacent ranges of values, where all values in the left
+     *      range are smaller than the values in the right range. The operation must be associative.
+     */
+
+
+    /**
+     * Represents the absence of an augmentation. Trees without an augmentation do not store aggregates.
+     */
+    struct NoAugment {
+        using type = void;
+    };
+
+    /**
+     * An augmentation which counts the number of values, including duplicate values.
+     */
+    template <class T>
+    struct Count {
+        using type = long long;
+        
+        static type identity() {
+            return 0;
+        }
+        
+        static type of(const T&, int amount) {
+            return amount;
+        }
+        
+        static type combine(const type& left, const type& right) {
+            return left + right;
+        }
+    };
+
+    /**
+     * An augmentation which sums the values, including duplicate values.
+     */
+    template <class T>
+    struct Sum {
+        using type = T;
+        
+        static type identity() {
+            return T();
+        }
+        
+        static type of(const T& value, int amount) {
+            return value * amount;
+        }
+        
+        static type combine(const type& left, const type& right) {
+            return left + right;
+        }
+    };
+
+    /**
+     * An augmentation which keeps the smallest value.
+     */
+    template <class T>
+    struct Min {
+        using type = T;
+        
+        static type identity() {
+            return numeric_limits<T>::max();
+        }
+        
+        static type of(const T& value, int amount) {
+            return value;
+        }
+        
+        static type combine(const type& left, const type& right) {
+            return right < left ? right : left;
+        }
+    };
+
+    /**
+     * An augmentation which keeps the largest value.
+     */
+    template <class T>
+    struct Max {
+        using type = T;
+        
+        static type identity() {
+            return numeric_limits<T>::lowest();
+        }
+        
+        static type of(const T& value, int amount) {
+            return value;
+        }
+        
+        static type combine(const type& left, const type& right) {
+            return left < right ? right : left;
+        }
+    };
+
+
+    /**
+     * Represents a node which stores the aggregate of its subtree in addition to its value.
+     */
+    template <class T, class Augment>
+    struct AugmentedNode : Node<T> {
+
+        typename Augment::type aggregate;
+        
+        using Node<T>::Node;
+
+    };
+
+    /**
+     * Maintains the aggregates of nodes using the specified augmentation.
+     */
+    template <class T, class Augment>
+    struct Augmentation {
+
+        using node = AugmentedNode<T, Augment>;
+        using type = typename Augment::type;
+        
+        /**
+         * Returns the aggregate of the subtree of the specified node.
+         *
+         * @param node the node
+         * @return the aggregate, or the identity if the node is null
+         */
+        static type aggregate(const shared_ptr<Node<T>>& node) {
+            return node ? static_cast<const AugmentedNode<T, Augment>&>(*node).aggregate : Augment::identity();
+        }
+        
+        /**
+         * Returns the aggregate of the specified node, excluding its children.
+         *
+         * @param node the node
+         * @return the aggregate of the node, or the identity if the node is a tombstone with an amount of 0
+         */
+        static type of(const shared_ptr<Node<T>>& node) {
+            return node->amount ? Augment::of(node->value, node->amount) : Augment::identity();
+        }
+        
+        /**
+         * Recomputes the aggregate of the specified node from the aggregates of its children.
+         *
+         * @param node the node to update
+         */
+        static void update(const shared_ptr<Node<T>>& node) {
+            static_cast<AugmentedNode<T, Augment>&>(*node).aggregate = Augment::combine(
+                Augment::combine(aggregate(node->left), of(node)), aggregate(node->right)
+            );
+        }
+        
+        /**
+         * Copies the aggregate of the specified source to the specified target.
+         * 
+         * @param source the node from which to copy
+         * @param target the node to which to copy
+         */
+        static void copy(const Node<T>& source, Node<T>& target) {
+            static_cast<AugmentedNode<T, Augment>&>(target).aggregate = static_cast<const AugmentedNode<T, Augment>&>(source).aggregate;
+        }
+    };
+
+    template <class T>
+    struct Augmentation<T, NoAugment> {
+
+        using node = Node<T>;
+        using type = void;
+        
+        static void update(const shared_ptr<Node<T>>&) {}
+        
+        static void copy(const Node<T>&, Node<T>&) {}
+    };
+
+}
+
+#endif /* AUGMENT_H */
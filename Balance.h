@@ -0,0 +1,612 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2018 PohSeng#1.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   Balance.h
+ * Author: Matthias Ngeo - S10172190F
+ * Author: Francis Koh - S10172072G
+ *
+ * Created on January 24, 2018, 9:12 PM
+ */
+
+#ifndef BALANCE_H
+#define BALANCE_H
+
+#include <algorithm>
+#include <memory>
+
+#include "Node.h"
+
+using namespace std;
+
+namespace assignment {
+
+    /*
+     * A balancing policy determines how the tree is restored after the structure of the tree is changed.
+     * Each policy interprets the balance of a node differently but shares the same node storage, and a
+     * balance of 0 is always a valid balance for a newly created leaf node.
+     *
+     * A policy provides the following static methods:
+     *
+     * added(Tree& tree, shared_ptr<Node<T>> node)
+     *      called after the specified node has been linked to the tree as a leaf.
+     *
+     * removed(Tree& tree, shared_ptr<Node<T>> parent, shared_ptr<Node<T>> child, bool left, int balance)
+     *      called after a node with the specified balance, which had at most one child, has been
+     *      unlinked from the tree and replaced by the specified child, which may be null, on the
+     *      left or right side of the specified parent, which is null if the removed node was the root.
+     *
+     * built(Node<T>& node, int left, int right, int depth, int height)
+     *      sets the balance of the specified node of a tree which was built from sorted nodes by
+     *      recursively taking the middle node as the root, given the heights of its subtrees, its depth
+     *      and the height of the tree.
+     *
+     * The tree grants the policy access to its root and rotations.
+     */
+
+
+    /**
+     * A balancing policy which maintains the tree as an AVL tree. The balance of a node is
+     * the height of its right subtree minus the height of its left subtree, and is always
+     * either -1, 0 or 1 after balancing.
+     */
+    struct AVLBalance {
+
+        /**
+         * Balances the tree after addition.
+         *
+         * @implSpec
+         * Iterates through the parents of the nodes, starting from the parent of the specified node
+         * and updates the balance each time before delegating rotation to appropriate
+         * method which depends on the balance.
+         *
+         * A balance of 0 indicates that the tree has been fully balanced and the loop terminates.
+         *
+         * @param tree the tree
+         * @param node the node which was added
+         */
+        template <class Tree, class T>
+        static void added(Tree& tree, shared_ptr<Node<T>> node);
+        
+        /**
+         * Balances the tree after removal.
+         *
+         * @implSpec
+         * Iterates through the parents of the nodes, starting from the specified parent
+         * and updates the balance each time before delegating rotation to appropriate
+         * method which depends on the balance.
+         *
+         * A balance of either 1 or -1 indicates that the height of the subtree is unchanged
+         * and that the tree has been balanced.
+         *
+         * @param tree the tree
+         * @param parent the parent of the node which was removed
+         * @param child the child which replaced the removed node
+         * @param left true if the removed node was the left child of the parent
+         * @param balance the balance of the removed node
+         */
+        template <class Tree, class T>
+        static void removed(Tree& tree, shared_ptr<Node<T>> parent, shared_ptr<Node<T>> child, bool left, int balance);
+        
+        /**
+         * Rotates the specified node to the left and updates the balance of the node and its right child.
+         *
+         * @param tree the tree
+         * @param node the node to rotate
+         * @return the right child of the specified node
+         */
+        template <class Tree, class T>
+        static shared_ptr<Node<T>> rotateLeft(Tree& tree, shared_ptr<Node<T>> node);
+        
+        /**
+         * Rotates the specified node to the right and updates the balance of the node and its left child.
+         *
+         * @param tree the tree
+         * @param node the node to rotate
+         * @return the left child of the specified node
+         */
+        template <class Tree, class T>
+        static shared_ptr<Node<T>> rotateRight(Tree& tree, shared_ptr<Node<T>> node);
+        
+        /**
+         * Sets the balance of the specified node of a tree built from sorted nodes.
+         *
+         * @param node the node
+         * @param left the height of the left subtree
+         * @param right the height of the right subtree
+         * @param depth the depth of the node
+         * @param height the height of the tree
+         */
+        template <class T>
+        static void built(Node<T>& node, int left, int right, int depth, int height);
+    };
+
+    template <class Tree, class T>
+    void AVLBalance::added(Tree& tree, shared_ptr<Node<T>> node) {
+        auto parent = node->parent;
+        while (parent) {
+            int balance = (parent->balance += (parent->left == node) ? -1 : 1);
+            
+            if (balance == 0) {
+                return;
+            
+            } else if (balance == -2) {
+                if (parent->left->balance == -1) {
+                    rotateRight(tree, parent);
+                
+                } else {
+                    rotateLeft(tree, parent->left);
+                    rotateRight(tree, parent);
+                }
+                return;
+            
+            } else if (balance == 2) {
+                if (parent->right->balance == 1) {
+                    rotateLeft(tree, parent);
+                
+                } else {
+                    rotateRight(tree, parent->right);
+                    rotateLeft(tree, parent);
+                }
+                return;
+            }
+            
+            node = parent;
+            parent = node->parent;
+        }
+    }
+
+    template <class Tree, class T>
+    void AVLBalance::removed(Tree& tree, shared_ptr<Node<T>> node, shared_ptr<Node<T>>, bool left, int balance) {
+        balance = left ? 1 : -1;
+        while (node) {
+            balance = (node->balance += balance);
+            if (balance == -2) {
+                if (node->left->balance <= 0) {
+                    node = rotateRight(tree, node);
+                
+                } else {
+                    rotateLeft(tree, node->left);
+                    node = rotateRight(tree, node);
+                }
+            
+            } else if (balance == 2) {
+                if (node->right->balance >= 0) {
+                    node = rotateLeft(tree, node);
+                
+                } else {
+                    rotateRight(tree, node->right);
+                    node = rotateLeft(tree, node);
+                }
+            }
+            
+            if (node->balance != 0) {
+                return;
+            }
+            
+            auto parent = node->parent;
+            if (parent) {
+                balance = (parent->left == node) ? 1 : -1;
+            }
+            node = parent;
+        }
+    }
+
+    template <class Tree, class T>
+    shared_ptr<Node<T>> AVLBalance::rotateLeft(Tree& tree, shared_ptr<Node<T>> node) {
+        auto right = tree.rotateLeft(node);
+        node->balance = node->balance - 1 - max(right->balance, 0);
+        right->balance = right->balance - 1 + min(node->balance, 0);
+        return right;
+    }
+
+    template <class Tree, class T>
+    shared_ptr<Node<T>> AVLBalance::rotateRight(Tree& tree, shared_ptr<Node<T>> node) {
+        auto left = tree.rotateRight(node);
+        node->balance = node->balance + 1 - min(left->balance, 0);
+        left->balance = left->balance + 1 + max(node->balance, 0);
+        return left;
+    }
+
+    template <class T>
+    void AVLBalance::built(Node<T>& node, int left, int right, int, int) {
+        node.balance = right - left;
+    }
+
+
+    /**
+     * A balancing policy which maintains the tree as a red-black tree. The balance of a node
+     * is its colour, either RED or BLACK. Newly added nodes are red.
+     *
+     * A red-black tree performs at most 2 rotations per addition and 3 rotations per removal,
+     * at the cost of a taller tree than an AVL tree.
+     */
+    struct RedBlackBalance {
+
+        static const int RED = 0;
+        static const int BLACK = 1;
+        
+        /**
+         * Restores the red-black properties after addition.
+         *
+         * @implSpec
+         * Recolours the parent, uncle and grandparent while both the node and its parent are red
+         * and the uncle is red, before rotating the grandparent once or twice if the uncle is black.
+         * The root is always recoloured black.
+         *
+         * @param tree the tree
+         * @param node the node which was added
+         */
+        template <class Tree, class T>
+        static void added(Tree& tree, shared_ptr<Node<T>> node);
+        
+        /**
+         * Restores the red-black properties after removal.
+         *
+         * @implSpec
+         * Does nothing if the removed node was red, and recolours the child black if it is red.
+         * Otherwise the child is "doubly black" and the extra black is pushed up the tree by recolouring
+         * the sibling while the sibling and its children are black, or removed with at most 3 rotations.
+         *
+         * @param tree the tree
+         * @param parent the parent of the node which was removed
+         * @param child the child which replaced the removed node
+         * @param left true if the removed node was the left child of the parent
+         * @param balance the colour of the removed node
+         */
+        template <class Tree, class T>
+        static void removed(Tree& tree, shared_ptr<Node<T>> parent, shared_ptr<Node<T>> child, bool left, int balance);
+        
+        /**
+         * Returns whether the specified node is black. Null nodes are black.
+         *
+         * @param node the node
+         * @return true if the node is null or black; else false
+         */
+        template <class T>
+        static bool black(const shared_ptr<Node<T>>& node);
+        
+        /**
+         * Sets the balance of the specified node of a tree built from sorted nodes, colouring the
+         * nodes on the deepest level red, except the root, and all other nodes black.
+         *
+         * @param node the node
+         * @param left the height of the left subtree
+         * @param right the height of the right subtree
+         * @param depth the depth of the node
+         * @param height the height of the tree
+         */
+        template <class T>
+        static void built(Node<T>& node, int left, int right, int depth, int height);
+    };
+
+    template <class Tree, class T>
+    void RedBlackBalance::added(Tree& tree, shared_ptr<Node<T>> node) {
+        auto parent = node->parent;
+        while (parent && parent->balance == RED) {
+            auto grandparent = parent->parent;
+            
+            if (grandparent->left == parent) {
+                auto uncle = grandparent->right;
+                if (!black(uncle)) {
+                    parent->balance = BLACK;
+                    uncle->balance = BLACK;
+                    grandparent->balance = RED;
+                    node = grandparent;
+                    parent = node->parent;
+                    continue;
+                }
+                
+                if (parent->right == node) {
+                    tree.rotateLeft(parent);
+                    parent = node;
+                }
+                parent->balance = BLACK;
+                grandparent->balance = RED;
+                tree.rotateRight(grandparent);
+                break;
+            
+            } else {
+                auto uncle = grandparent->left;
+                if (!black(uncle)) {
+                    parent->balance = BLACK;
+                    uncle->balance = BLACK;
+                    grandparent->balance = RED;
+                    node = grandparent;
+                    parent = node->parent;
+                    continue;
+                }
+                
+                if (parent->left == node) {
+                    tree.rotateRight(parent);
+                    parent = node;
+                }
+                parent->balance = BLACK;
+                grandparent->balance = RED;
+                tree.rotateLeft(grandparent);
+                break;
+            }
+        }
+        
+        tree.root->balance = BLACK;
+    }
+
+    template <class Tree, class T>
+    void RedBlackBalance::removed(Tree& tree, shared_ptr<Node<T>> parent, shared_ptr<Node<T>> node, bool left, int balance) {
+        if (balance == RED) {
+            return;
+        }
+        
+        while (parent && black(node)) {
+            if (left) {
+                auto sibling = parent->right;
+                if (!black(sibling)) {
+                    sibling->balance = BLACK;
+                    parent->balance = RED;
+                    tree.rotateLeft(parent);
+                    sibling = parent->right;
+                }
+                
+                if (black(sibling->left) && black(sibling->right)) {
+                    sibling->balance = RED;
+                    node = parent;
+                
+                } else {
+                    if (black(sibling->right)) {
+                        sibling->left->balance = BLACK;
+                        sibling->balance = RED;
+                        sibling = tree.rotateRight(sibling);
+                    }
+                    sibling->balance = parent->balance;
+                    parent->balance = BLACK;
+                    sibling->right->balance = BLACK;
+                    tree.rotateLeft(parent);
+                    node = tree.root;
+                }
+            
+            } else {
+                auto sibling = parent->left;
+                if (!black(sibling)) {
+                    sibling->balance = BLACK;
+                    parent->balance = RED;
+                    tree.rotateRight(parent);
+                    sibling = parent->left;
+                }
+                
+                if (black(sibling->left) && black(sibling->right)) {
+                    sibling->balance = RED;
+                    node = parent;
+                
+                } else {
+                    if (black(sibling->left)) {
+                        sibling->right->balance = BLACK;
+                        sibling->balance = RED;
+                        sibling = tree.rotateLeft(sibling);
+                    }
+                    sibling->balance = parent->balance;
+                    parent->balance = BLACK;
+                    sibling->left->balance = BLACK;
+                    tree.rotateRight(parent);
+                    node = tree.root;
+                }
+            }
+            
+            parent = node->parent;
+            if (parent) {
+                left = parent->left == node;
+            }
+        }
+        
+        if (node) {
+            node->balance = BLACK;
+        }
+    }
+
+    template <class T>
+    bool RedBlackBalance::black(const shared_ptr<Node<T>>& node) {
+        return !node || node->balance == BLACK;
+    }
+
+    template <class T>
+    void RedBlackBalance::built(Node<T>& node, int, int, int depth, int height) {
+        node.balance = depth > 0 && depth == height - 1 ? RED : BLACK;
+    }
+
+
+    /**
+     * A balancing policy which maintains the tree as a weak AVL (WAVL) tree. The balance of a node
+     * is its rank, where leaves have a rank of 0 and null nodes a rank of -1. The rank difference
+     * between a node and each of its children is always either 1 or 2.
+     *
+     * A WAVL tree behaves as an AVL tree if no removals take place and performs at most
+     * 2 rotations per addition or removal, with the remaining work being rank changes
+     * which are amortized O(1).
+     */
+    struct WAVLBalance {
+
+        /**
+         * Restores the rank rule after addition.
+         *
+         * @implSpec
+         * Promotes the parent while the node has a rank difference of 0 and its sibling
+         * a rank difference of 1, before performing a single or double rotation if the sibling
+         * has a rank difference of 2.
+         *
+         * @param tree the tree
+         * @param node the node which was added
+         */
+        template <class Tree, class T>
+        static void added(Tree& tree, shared_ptr<Node<T>> node);
+        
+        /**
+         * Restores the rank rule after removal.
+         *
+         * @implSpec
+         * Demotes the parent if it has become a leaf with a rank of 1. Afterwards demotes the parent,
+         * and possibly the sibling, while the node has a rank difference of 3 and the sibling is either a
+         * 2-child or a 1-child with two 2-children, before performing a single or double rotation.
+         *
+         * @param tree the tree
+         * @param parent the parent of the node which was removed
+         * @param child the child which replaced the removed node
+         * @param left true if the removed node was the left child of the parent
+         * @param balance the rank of the removed node
+         */
+        template <class Tree, class T>
+        static void removed(Tree& tree, shared_ptr<Node<T>> parent, shared_ptr<Node<T>> child, bool left, int balance);
+        
+        /**
+         * Returns the rank of the specified node.
+         *
+         * @param node the node
+         * @return the rank of the node, or -1 if the node is null
+         */
+        template <class T>
+        static int rank(const shared_ptr<Node<T>>& node);
+        
+        /**
+         * Sets the balance of the specified node of a tree built from sorted nodes, whose rank is its
+         * height minus 1, as in an AVL tree.
+         *
+         * @param node the node
+         * @param left the height of the left subtree
+         * @param right the height of the right subtree
+         * @param depth the depth of the node
+         * @param height the height of the tree
+         */
+        template <class T>
+        static void built(Node<T>& node, int left, int right, int depth, int height);
+    };
+
+    template <class Tree, class T>
+    void WAVLBalance::added(Tree& tree, shared_ptr<Node<T>> node) {
+        auto parent = node->parent;
+        while (parent && parent->balance == node->balance) {
+            bool left = parent->left == node;
+            auto sibling = left ? parent->right : parent->left;
+            
+            if (parent->balance - rank(sibling) == 1) {
+                parent->balance++;
+                node = parent;
+                parent = node->parent;
+                continue;
+            }
+            
+            auto inner = left ? node->right : node->left;
+            if (node->balance - rank(inner) == 2) {
+                if (left) {
+                    tree.rotateRight(parent);
+                
+                } else {
+                    tree.rotateLeft(parent);
+                }
+                parent->balance--;
+            
+            } else {
+                if (left) {
+                    tree.rotateLeftRight(parent);
+                
+                } else {
+                    tree.rotateRightLeft(parent);
+                }
+                inner->balance++;
+                node->balance--;
+                parent->balance--;
+            }
+            return;
+        }
+    }
+
+    template <class Tree, class T>
+    void WAVLBalance::removed(Tree& tree, shared_ptr<Node<T>> parent, shared_ptr<Node<T>> node, bool left, int) {
+        if (parent && !parent->left && !parent->right && parent->balance == 1) {
+            parent->balance = 0;
+            node = parent;
+            parent = node->parent;
+            if (parent) {
+                left = parent->left == node;
+            }
+        }
+        
+        while (parent && parent->balance - rank(node) == 3) {
+            auto sibling = left ? parent->right : parent->left;
+            
+            if (parent->balance - sibling->balance == 2) {
+                parent->balance--;
+            
+            } else if (sibling->balance - rank(sibling->left) == 2 && sibling->balance - rank(sibling->right) == 2) {
+                parent->balance--;
+                sibling->balance--;
+            
+            } else {
+                auto outer = left ? sibling->right : sibling->left;
+                if (sibling->balance - rank(outer) == 1) {
+                    if (left) {
+                        tree.rotateLeft(parent);
+                    
+                    } else {
+                        tree.rotateRight(parent);
+                    }
+                    sibling->balance++;
+                    parent->balance--;
+                    if (!parent->left && !parent->right) {
+                        parent->balance--;
+                    }
+                
+                } else {
+                    auto inner = left ? sibling->left : sibling->right;
+                    if (left) {
+                        tree.rotateRightLeft(parent);
+                    
+                    } else {
+                        tree.rotateLeftRight(parent);
+                    }
+                    inner->balance += 2;
+                    sibling->balance--;
+                    parent->balance -= 2;
+                }
+                return;
+            }
+            
+            node = parent;
+            parent = node->parent;
+            if (parent) {
+                left = parent->left == node;
+            }
+        }
+    }
+
+    template <class T>
+    int WAVLBalance::rank(const shared_ptr<Node<T>>& node) {
+        return node ? node->balance : -1;
+    }
+
+    template <class T>
+    void WAVLBalance::built(Node<T>& node, int left, int right, int, int) {
+        node.balance = max(left, right);
+    }
+
+}
+
+#endif /* BALANCE_H */
@@ -0,0 +1,182 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2018 PohSeng#1.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   Filter.h
+ * Author: Matthias Ngeo - S10172190F
+ * Author: Francis Koh - S10172072G
+ *
+ * Created on January 29, 2018, 10:05 PM
+ */
+
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+namespace assignment {
+
+    /**
+     * Returns a well-mixed 64-bit digest of the specified value using std::hash.
+     *
+     * @param value the value
+     * @return the digest
+     */
+    template <class T>
+    uint64_t digest(const T& value) {
+        uint64_t hash = std::hash<T>()(value);
+        hash ^= hash >> 30;
+        hash *= 0xbf58476d1ce4e5b9ULL;
+        hash ^= hash >> 27;
+        hash *= 0x94d049bb133111ebULL;
+        hash ^= hash >> 31;
+        return hash;
+    }
+
+
+    /**
+     * Represents a blocked Bloom filter over the digests of values. All bits of a digest are set within
+     * a single 512-bit block, so that a lookup touches at most one cache line.
+     *
+     * The filter may report that it contains a digest which was never added, but never reports that it
+     * does not contain a digest which was added. Digests cannot be removed.
+     */
+    class BloomFilter {
+        private:
+            static const int BLOCK = 512;
+            static const int WORDS = BLOCK / 64;
+            
+            vector<uint64_t> words;
+            size_t blocks;
+            size_t limit;
+            int hashes;
+            
+            /**
+             * Returns the first word of the block for the specified digest.
+             *
+             * @param digest the digest
+             * @return the first word of the block
+             */
+            const uint64_t* block(uint64_t digest) const;
+        
+        public:
+            /**
+             * Constructs an empty BloomFilter for the specified number of digests which reports digests
+             * which were never added with approximately the specified rate.
+             *
+             * @param capacity the number of digests
+             * @param rate the false positive rate, between 0 and 1 exclusive
+             * @throws invalid_argument if the rate is not between 0 and 1 exclusive
+             */
+            BloomFilter(size_t capacity, double rate);
+            
+            /**
+             * Adds the specified digest.
+             *
+             * @param digest the digest
+             */
+            void add(uint64_t digest);
+            
+            /**
+             * Returns whether the specified digest may have been added.
+             *
+             * @param digest the digest
+             * @return false if the digest was definitely not added; else true
+             */
+            bool contains(uint64_t digest) const;
+            
+            /**
+             * Returns the number of digests for which the false positive rate holds.
+             *
+             * @return the capacity
+             */
+            size_t capacity() const;
+            
+            /**
+             * Returns the memory used by the filter in bytes.
+             *
+             * @return the memory used
+             */
+            size_t memory() const;
+    };
+
+    inline BloomFilter::BloomFilter(size_t capacity, double rate) {
+        if (!(0 < rate && rate < 1)) {
+            throw invalid_argument("False positive rate must be between 0 and 1");
+        }
+        
+        auto ln2 = log(2.0);
+        auto bits = -log(rate) / (ln2 * ln2);
+        
+        limit = capacity > 0 ? capacity : 1;
+        blocks = (size_t) ceil(limit * bits * 1.1 / BLOCK);
+        hashes = (int) round(bits * ln2);
+        hashes = hashes < 1 ? 1 : (hashes > 16 ? 16 : hashes);
+        words = vector<uint64_t>(blocks * WORDS, 0);
+    }
+
+    inline const uint64_t* BloomFilter::block(uint64_t digest) const {
+        return &words[((digest >> 32) * blocks >> 32) * WORDS];
+    }
+
+    inline void BloomFilter::add(uint64_t digest) {
+        auto words = const_cast<uint64_t*>(block(digest));
+        uint32_t bit = (uint32_t) digest;
+        uint32_t step = (uint32_t) (digest >> 32) * 0x9e3779b9U | 1;
+        
+        for (int i = 0; i < hashes; i++, bit += step) {
+            words[(bit % BLOCK) / 64] |= 1ULL << (bit % 64);
+        }
+    }
+
+    inline bool BloomFilter::contains(uint64_t digest) const {
+        auto words = block(digest);
+        uint32_t bit = (uint32_t) digest;
+        uint32_t step = (uint32_t) (digest >> 32) * 0x9e3779b9U | 1;
+        
+        for (int i = 0; i < hashes; i++, bit += step) {
+            if (!(words[(bit % BLOCK) / 64] & (1ULL << (bit % 64)))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline size_t BloomFilter::capacity() const {
+        return limit;
+    }
+
+    inline size_t BloomFilter::memory() const {
+        return words.size() * sizeof(uint64_t);
+    }
+
+}
+
+#endif /* FILTER_H */
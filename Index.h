@@ -0,0 +1,207 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2018 PohSeng#1.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   Index.h
+ * Author: Matthias Ngeo - S10172190F
+ * Author: Francis Koh - S10172072G
+ *
+ * Created on January 30, 2018, 8:20 PM
+ */
+
+#ifndef INDEX_H
+#define INDEX_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Node.h"
+
+using namespace std;
+
+namespace assignment {
+
+    /**
+     * Represents an open-addressing hash table which maps the values of nodes to the nodes, using linear 
+     * probing over the digests of the values. The nodes are not owned by the index, and must be removed 
+     * from the index before they are freed.
+     */
+    template <class T>
+    class HashIndex {
+        private:
+            /**
+             * Represents a slot in the table, which is empty if the node is null.
+             */
+            struct Slot {
+                uint64_t digest;
+                Node<T>* node;
+            };
+            
+            vector<Slot> slots;
+            size_t mask;
+            size_t count;
+            
+            /**
+             * Doubles the number of slots and reinserts the nodes.
+             */
+            void grow();
+        
+        public:
+            /**
+             * Constructs an empty HashIndex which holds the specified number of nodes without growing.
+             *
+             * @param capacity the number of nodes
+             */
+            HashIndex(size_t capacity = 0);
+            
+            /**
+             * Returns the node which contains the specified value.
+             *
+             * @param value the value
+             * @param digest the digest of the value
+             * @return the node, or null if the index does not contain the value
+             */
+            Node<T>* find(const T& value, uint64_t digest) const;
+            
+            /**
+             * Adds the specified node, whose value must not already be in the index.
+             *
+             * @param node the node
+             * @param digest the digest of the value of the node
+             */
+            void add(Node<T>* node, uint64_t digest);
+            
+            /**
+             * Removes the specified node.
+             * 
+             * @implSpec
+             * Shifts the nodes which follow the removed node in the same run of slots backwards, 
+             * so that no tombstones are left behind and lookups do not degrade over time.
+             *
+             * @param node the node
+             * @param digest the digest of the value of the node
+             */
+            void remove(Node<T>* node, uint64_t digest);
+            
+            /**
+             * Removes all nodes from the index.
+             */
+            void clear();
+            
+            /**
+             * Returns the memory used by the index in bytes.
+             *
+             * @return the memory used
+             */
+            size_t memory() const;
+    };
+
+    template <class T>
+    HashIndex<T>::HashIndex(size_t capacity) {
+        size_t size = 16;
+        while (size < 2 * capacity) {
+            size *= 2;
+        }
+        
+        slots = vector<Slot>(size, Slot{0, nullptr});
+        mask = size - 1;
+        count = 0;
+    }
+
+    template <class T>
+    Node<T>* HashIndex<T>::find(const T& value, uint64_t digest) const {
+        for (auto i = digest & mask; slots[i].node; i = (i + 1) & mask) {
+            if (slots[i].digest == digest && slots[i].node->value == value) {
+                return slots[i].node;
+            }
+        }
+        return nullptr;
+    }
+
+    template <class T>
+    void HashIndex<T>::add(Node<T>* node, uint64_t digest) {
+        if (2 * (count + 1) > slots.size()) {
+            grow();
+        }
+        
+        auto i = digest & mask;
+        while (slots[i].node) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = Slot{digest, node};
+        count++;
+    }
+
+    template <class T>
+    void HashIndex<T>::remove(Node<T>* node, uint64_t digest) {
+        auto i = digest & mask;
+        while (slots[i].node && slots[i].node != node) {
+            i = (i + 1) & mask;
+        }
+        if (!slots[i].node) {
+            return;
+        }
+        
+        for (auto j = (i + 1) & mask; slots[j].node; j = (j + 1) & mask) {
+            auto home = slots[j].digest & mask;
+            if (((j - home) & mask) >= ((j - i) & mask)) {
+                slots[i] = slots[j];
+                i = j;
+            }
+        }
+        slots[i] = Slot{0, nullptr};
+        count--;
+    }
+
+    template <class T>
+    void HashIndex<T>::grow() {
+        vector<Slot> old(slots.size() * 2, Slot{0, nullptr});
+        old.swap(slots);
+        mask = slots.size() - 1;
+        
+        for (auto& slot : old) {
+            if (slot.node) {
+                auto i = slot.digest & mask;
+                while (slots[i].node) {
+                    i = (i + 1) & mask;
+                }
+                slots[i] = slot;
+            }
+        }
+    }
+
+    template <class T>
+    void HashIndex<T>::clear() {
+        slots.assign(slots.size(), Slot{0, nullptr});
+        count = 0;
+    }
+
+    template <class T>
+    size_t HashIndex<T>::memory() const {
+        return slots.size() * sizeof(Slot);
+    }
+
+}
+
+#endif /* INDEX_H */
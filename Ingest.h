@@ -0,0 +1,366 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2018 PohSeng#1.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   Ingest.h
+ * Author: Matthias Ngeo - S10172190F
+ * Author: Francis Koh - S10172072G
+ *
+ * Created on February 6, 2018, 2:45 PM
+ */
+
+#ifndef INGEST_H
+#define INGEST_H
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Pool.h"
+
+using namespace std;
+
+namespace assignment {
+
+    /**
+     * Represents a read-only memory mapping of a whole file, which is unmapped when destroyed.
+     */
+    class MappedFile {
+        private:
+            const char* data;
+            size_t length;
+        
+        public:
+            /**
+             * Constructs a MappedFile which maps the file at the specified path.
+             *
+             * @param path the path of the file
+             * @throws system_error if the file could not be opened or mapped
+             */
+            MappedFile(const string& path);
+            
+            MappedFile(const MappedFile& other) = delete;
+            
+            MappedFile& operator=(const MappedFile& other) = delete;
+            
+            /**
+             * Unmaps the file.
+             */
+            ~MappedFile();
+            
+            /**
+             * Returns the first character of the file.
+             *
+             * @return the first character, or null if the file is empty
+             */
+            const char* begin() const;
+            
+            /**
+             * Returns the position after the last character of the file.
+             *
+             * @return the position after the last character
+             */
+            const char* end() const;
+            
+            /**
+             * Returns the size of the file in bytes.
+             *
+             * @return the size of the file
+             */
+            size_t size() const;
+    };
+
+    inline MappedFile::MappedFile(const string& path) : data(nullptr), length(0) {
+        int file = open(path.c_str(), O_RDONLY);
+        if (file < 0) {
+            throw system_error(errno, system_category(), "Failed to open " + path);
+        }
+        
+        struct stat status;
+        if (fstat(file, &status) < 0) {
+            auto error = errno;
+            close(file);
+            throw system_error(error, system_category(), "Failed to read the size of " + path);
+        }
+        
+        length = status.st_size;
+        if (length > 0) {
+            auto mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+            if (mapping == MAP_FAILED) {
+                auto error = errno;
+                close(file);
+                throw system_error(error, system_category(), "Failed to map " + path);
+            }
+            
+            madvise(mapping, length, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(mapping);
+        }
+        close(file);
+    }
+
+    inline MappedFile::~MappedFile() {
+        if (data) {
+            munmap(const_cast<char*>(data), length);
+        }
+    }
+
+    inline const char* MappedFile::begin() const {
+        return data;
+    }
+
+    inline const char* MappedFile::end() const {
+        return data + length;
+    }
+
+    inline size_t MappedFile::size() const {
+        return length;
+    }
+
+
+    /**
+     * Returns the number of leading decimal digits in the specified 8 characters.
+     *
+     * @implSpec
+     * Tests all 8 characters at once within a 64-bit word, without branching on each character. A
+     * character is a digit if it lies between 0 and 9 after the '0' bit pattern is cleared and still does
+     * not exceed 15 after adding 6. Carries between characters only occur after a character which is not
+     * a digit, and hence do not affect the leading digits.
+     *
+     * @param word the characters, with the first character in the least significant byte
+     * @return the number of leading digits, between 0 and 8
+     */
+    inline int digits(uint64_t word) {
+        auto values = word ^ 0x3030303030303030ULL;
+        auto rejected = (values | (values + 0x0606060606060606ULL)) & 0xF0F0F0F0F0F0F0F0ULL;
+        return rejected ? __builtin_ctzll(rejected) / 8 : 8;
+    }
+
+    /**
+     * Returns the value of the specified number of leading decimal digits in the specified 8 characters.
+     *
+     * @implSpec
+     * Shifts the digits into the most significant bytes, so that the remaining bytes act as leading
+     * zeros, before combining adjacent digits, pairs and quadruples of digits with 3 multiplications.
+     *
+     * @param word the characters, with the first character in the least significant byte
+     * @param count the number of leading digits, between 1 and 8
+     * @return the value of the digits
+     */
+    inline uint32_t convert(uint64_t word, int count) {
+        word = (word & 0x0F0F0F0F0F0F0F0FULL) << (8 * (8 - count));
+        word = (word * 10 + (word >> 8)) & 0x00FF00FF00FF00FFULL;
+        word = (word * 100 + (word >> 16)) & 0x0000FFFF0000FFFFULL;
+        return (uint32_t) (word * 10000 + (word >> 32));
+    }
+
+    /**
+     * Parses the newline-separated integers in the specified range of characters and appends them to
+     * the specified values. Empty lines are skipped and lines may end with a carriage return.
+     *
+     * @implSpec
+     * Parses the digits of each integer 8 characters at a time using #digits(uint64_t word) and
+     * #convert(uint64_t word, int count) while at least 8 characters remain, and one character at
+     * a time otherwise. Hence, an integer of up to 8 digits is typically parsed without a loop.
+     *
+     * @param first the first character
+     * @param last the position after the last character
+     * @param values the values to which the integers are appended
+     * @throws invalid_argument if a line is not an integer or the integer does not fit in an int
+     */
+    inline void parse(const char* first, const char* last, vector<int>& values) {
+        static const int64_t powers[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+        
+        auto position = first;
+        while (position < last) {
+            auto line = position;
+            bool negative = *position == '-';
+            position += negative;
+            
+            int64_t value = 0;
+            int count = 0;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            while (last - position >= 8 && count <= 10) {
+                uint64_t word;
+                memcpy(&word, position, sizeof(word));
+                auto leading = digits(word);
+                if (leading == 0) {
+                    break;
+                }
+                
+                value = value * powers[leading] + convert(word, leading);
+                position += leading;
+                count += leading;
+                if (leading < 8) {
+                    break;
+                }
+            }
+#endif
+            while (position < last && '0' <= *position && *position <= '9' && count < 18) {
+                value = value * 10 + (*position - '0');
+                position++;
+                count++;
+            }
+            
+            if (position < last && *position == '\r') {
+                position++;
+            }
+            
+            auto end = position;
+            if ((position < last && *position != '\n') || (count == 0 && negative)) {
+                bool digit = position < last && '0' <= *position && *position <= '9';
+                end = static_cast<const char*>(memchr(position, '\n', last - position));
+                end = end ? end : last;
+                throw invalid_argument((digit ? "Integer does not fit in an int: " : "Line is not an integer: ") + string(line, end));
+            
+            } else if (count > 0) {
+                value = negative ? -value : value;
+                if (value < numeric_limits<int>::min() || value > numeric_limits<int>::max()) {
+                    throw invalid_argument("Integer does not fit in an int: " + string(line, end));
+                }
+                values.push_back((int) value);
+            }
+            position++;
+        }
+    }
+
+    /**
+     * Calls the specified function with each index in the specified range, in parallel using the
+     * specified pool.
+     *
+     * @param from the first index
+     * @param to the index after the last index
+     * @param function the function to call with each index
+     * @param pool the pool used to call the function in parallel
+     */
+    template <class Function>
+    void parallel(int from, int to, const Function& function, ThreadPool& pool) {
+        if (to - from <= 1) {
+            if (from < to) {
+                function(from);
+            }
+            return;
+        }
+        
+        int middle = from + (to - from) / 2;
+        pool.join([&]() {
+            parallel(from, middle, function, pool);
+        }, [&]() {
+            parallel(middle, to, function, pool);
+        });
+    }
+
+    /**
+     * Reads the newline-separated integers in the file at the specified path, in ascending order.
+     *
+     * @implSpec
+     * Maps the file into memory and splits it into several chunks per thread of the pool at the
+     * newlines nearest to equally spaced positions. Each chunk is parsed using
+     * #parse(const char* first, const char* last, vector<int>& values) and sorted in parallel, before
+     * pairs of sorted runs are merged in parallel until a single run remains. Parsing touches each page
+     * of the file once and sorting only touches the parsed integers, so reading a large file is bound by
+     * the speed at which the pages of the file are read.
+     *
+     * @param path the path of the file
+     * @param pool the pool used to parse and sort the integers in parallel, or the shared pool if unspecified
+     * @return the integers in ascending order
+     * @throws system_error if the file could not be opened or mapped
+     * @throws invalid_argument if a line is not an integer or the integer does not fit in an int
+     */
+    inline vector<int> read(const string& path, ThreadPool& pool = ThreadPool::shared()) {
+        MappedFile file(path);
+        
+        size_t chunks = max((size_t) 1, min(file.size() / (64 * 1024), (size_t) pool.size() * 8));
+        vector<const char*> bounds = {file.begin()};
+        for (size_t i = 1; i < chunks; i++) {
+            auto bound = max(bounds.back(), file.begin() + file.size() * i / chunks);
+            auto newline = static_cast<const char*>(memchr(bound, '\n', file.end() - bound));
+            bounds.push_back(newline ? newline + 1 : file.end());
+        }
+        bounds.push_back(file.end());
+        
+        vector<vector<int>> runs(chunks);
+        parallel(0, chunks, [&](int i) {
+            runs[i].reserve((bounds[i + 1] - bounds[i]) / 8);
+            parse(bounds[i], bounds[i + 1], runs[i]);
+            sort(runs[i].begin(), runs[i].end());
+        }, pool);
+        
+        while (runs.size() > 1) {
+            vector<vector<int>> merged((runs.size() + 1) / 2);
+            parallel(0, merged.size(), [&](int i) {
+                if (2 * i + 1 == (int) runs.size()) {
+                    merged[i] = std::move(runs[2 * i]);
+                    return;
+                }
+                
+                auto& left = runs[2 * i];
+                auto& right = runs[2 * i + 1];
+                merged[i].resize(left.size() + right.size());
+                merge(left.begin(), left.end(), right.begin(), right.end(), merged[i].begin());
+                vector<int>().swap(left);
+                vector<int>().swap(right);
+            }, pool);
+            runs = std::move(merged);
+        }
+        
+        return std::move(runs[0]);
+    }
+
+    /**
+     * Replaces the values in the specified tree with the newline-separated integers in the file at the
+     * specified path.
+     *
+     * @implSpec
+     * Reads the integers using #read(const string& path, ThreadPool& pool) and builds the tree from
+     * them in linear time using the tree's load(const vector<int>& sorted) method.
+     *
+     * @param tree the tree
+     * @param path the path of the file
+     * @param pool the pool used to parse and sort the integers in parallel, or the shared pool if unspecified
+     * @throws system_error if the file could not be opened or mapped
+     * @throws invalid_argument if a line is not an integer or the integer does not fit in an int
+     */
+    template <class Tree>
+    void ingest(Tree& tree, const string& path, ThreadPool& pool = ThreadPool::shared()) {
+        tree.load(read(path, pool));
+    }
+
+}
+
+#endif
+
+#endif /* INGEST_H */
@@ -33,7 +33,10 @@
 #ifndef ITERATOR_H
 #define ITERATOR_H
 
+#include <algorithm>
+#include <memory>
 #include <stdexcept>
+#include <vector>
 
 #include "Queue.h"
 #include "Node.h"
@@ -123,6 +126,13 @@ namespace assignment {
             shared_ptr<Node<T>> right;
             Direction direction;
             
+            /**
+             * Iterates to the next element in an ascending order, including tombstones.
+             * 
+             * @return true if the iteration has more elements; else false
+             */
+            bool step();
+            
         public:
             using Iterator<T>::current;
             using Iterator<T>::operator++;
@@ -138,10 +148,13 @@ namespace assignment {
             }
             
             /**
-            * Iterates to the next element in the iteration in an ascending order.
+            * Iterates to the next element in the iteration in an ascending order, skipping tombstones,
+            * which are nodes with an amount of 0 left behind by the lazy removal of an AVL tree.
             * 
              * @implSpec
-             * The method first determines the direction of the traversal.
+             * Delegates to #step() until an element which is not a tombstone is reached.
+             * 
+             * #step() first determines the direction of the traversal.
              * 
              * If the direction is RIGHT, it sets the right child of the previous element as the current element.
              * After which, it sets the it sets the left-most leaf element of the current element as the next node,
@@ -165,6 +178,16 @@ namespace assignment {
     
     template <class T>
     bool AscendingIterator<T>::operator++() {
+        while (step()) {
+            if (current->amount > 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    template <class T>
+    bool AscendingIterator<T>::step() {
         if (direction == Direction::RIGHT) {
             current = right;
             
@@ -209,6 +232,13 @@ namespace assignment {
     class LevelIterator : public Iterator<T> {
         private:
             Queue<shared_ptr<Node<T>>> nodes;
+            
+            /**
+             * Iterates to the next element level-by-level, including tombstones.
+             * 
+             * @return true if the iteration has more elements; else false
+             */
+            bool step();
         
         public:
             using Iterator<T>::current;
@@ -218,17 +248,19 @@ namespace assignment {
              * Constructs a LevelIterator with the specified root and pushes the root to the queue if non-null.
              */
             LevelIterator(shared_ptr<Node<T>> root) : Iterator<T>(root) {
-                nodes = Queue<shared_ptr<Node<T>>>();
                 if (current) {
                     nodes.push(current);
                 }
             }
             
             /**
-            * Iterates to the next element in the iteration, level-by-level.
+            * Iterates to the next element in the iteration, level-by-level, skipping tombstones,
+            * which are nodes with an amount of 0 left behind by the lazy removal of an AVL tree.
             * 
              * @implSpec
-             * If the queue is not empty, set the element at the head of the queue as the 
+             * Delegates to #step() until an element which is not a tombstone is reached.
+             * 
+             * In #step(), if the queue is not empty, set the element at the head of the queue as the 
              * current element and pop the queue before adding the left and right child
              * of the current element to the queue if they exist respectively.
              * 
@@ -242,6 +274,16 @@ namespace assignment {
     
     template <class T>
     bool LevelIterator<T>::operator++() {
+        while (step()) {
+            if (current->amount > 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    template <class T>
+    bool LevelIterator<T>::step() {
         if (!nodes.empty()) {
             current = nodes.front();
             nodes.pop();
@@ -257,6 +299,128 @@ namespace assignment {
         } else {
             return false;
         }
+    }    
+    
+    /**
+     * A concrete subclass of Iterator which merges the elements of multiple ascending iterators,
+     * such as those of several AVL trees. The elements will be returned in ascending order across
+     * all iterators. Elements with equal values in different iterators are returned consecutively,
+     * or as a single element whose amount is the sum of their amounts if the iterator combines them.
+     * 
+     * The iterator holds only the merged iterators, which must not be modified while they are merged.
+     */
+    template <class T>
+    class MergeIterator : public Iterator<T> {
+        private:
+            vector<shared_ptr<Iterator<T>>> cursors;
+            shared_ptr<Node<T>> combined;
+            bool combine;
+            
+            /**
+             * Returns whether the current element of the first specified iterator is larger than
+             * the current element of the second specified iterator.
+             * 
+             * @param first the first iterator
+             * @param second the second iterator
+             * @return true if the first element is larger; else false
+             */
+            static bool later(const shared_ptr<Iterator<T>>& first, const shared_ptr<Iterator<T>>& second);
+            
+            /**
+             * Removes the iterator with the smallest current element from the heap, and returns its
+             * current element after iterating it to its next element, adding it back to the heap
+             * if it has more elements.
+             * 
+             * @return the smallest current element
+             */
+            shared_ptr<Node<T>> next();
+        
+        public:
+            using Iterator<T>::current;
+            using Iterator<T>::operator++;
+            
+            /**
+             * Constructs a MergeIterator over the specified ascending iterators, none of which may have
+             * been iterated.
+             * 
+             * @param iterators the ascending iterators
+             * @param combine true if elements with equal values are combined; false if unspecified
+             */
+            MergeIterator(vector<shared_ptr<Iterator<T>>> iterators, bool combine = false);
+            
+            /**
+            * Iterates to the next element in the iteration in an ascending order.
+            * 
+             * @implSpec
+             * Keeps the iterators in a binary heap ordered by their current elements, so that the memory 
+             * used is proportional to the number of iterators and each iteration takes O(log(k)) time in
+             * addition to the iteration of the merged iterator. If elements are combined, the iterators 
+             * whose current elements are equal to the smallest element are also iterated, and a single 
+             * node owned by this iterator is reused to return the combined amounts.
+             * 
+            * @return true if the iteration has more elements; else false
+            */
+            bool operator++() override;
+    };
+    
+    
+    template <class T>
+    MergeIterator<T>::MergeIterator(vector<shared_ptr<Iterator<T>>> iterators, bool combine) : Iterator<T>(nullptr) {
+        for (auto& iterator : iterators) {
+            if ((*iterator)++) {
+                cursors.push_back(iterator);
+            }
+        }
+        make_heap(cursors.begin(), cursors.end(), later);
+        this->combine = combine;
+    }
+    
+    template <class T>
+    bool MergeIterator<T>::later(const shared_ptr<Iterator<T>>& first, const shared_ptr<Iterator<T>>& second) {
+        return second->get()->value < first->get()->value;
+    }
+    
+    template <class T>
+    shared_ptr<Node<T>> MergeIterator<T>::next() {
+        pop_heap(cursors.begin(), cursors.end(), later);
+        auto cursor = cursors.back();
+        auto node = cursor->get();
+        
+        if ((*cursor)++) {
+            push_heap(cursors.begin(), cursors.end(), later);
+        } else {
+            cursors.pop_back();
+        }
+        return node;
+    }
+    
+    template <class T>
+    bool MergeIterator<T>::operator++() {
+        if (cursors.empty()) {
+            current = nullptr;
+            return false;
+        }
+        
+        current = next();
+        if (!combine) {
+            return true;
+        }
+        
+        auto amount = current->amount;
+        while (!cursors.empty() && !(current->value < cursors.front()->get()->value)) {
+            amount += next()->amount;
+        }
+        
+        if (amount != current->amount) {
+            if (combined) {
+                combined->value = current->value;
+            } else {
+                combined = make_shared<Node<T>>(current->value);
+            }
+            combined->amount = amount;
+            current = combined;
+        }
+        return true;
     }
 }
 
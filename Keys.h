@@ -0,0 +1,401 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2018 PohSeng#1.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   Keys.h
+ * Author: Matthias Ngeo - S10172190F
+ * Author: Francis Koh - S10172072G
+ *
+ * Created on February 4, 2018, 4:30 PM
+ */
+
+#ifndef KEYS_H
+#define KEYS_H
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Filter.h"
+
+using namespace std;
+
+namespace assignment {
+
+    /*
+     * A key policy determines how the values of a PackedAVLTree are stored in its nodes.
+     *
+     * A key policy provides the following:
+     *
+     * type
+     *      the type of the key which is stored in each node.
+     *
+     * query
+     *      the type of a value which has been prepared for comparison.
+     *
+     * prepare(const T& value)
+     *      returns the query for the specified value, which is computed once per operation.
+     *
+     * compare(const query& query, const type& key)
+     *      returns -1, 0 or 1 if the queried value is respectively smaller than, equal to or larger
+     *      than the value of the key.
+     *
+     * fits(const T& value)
+     *      returns whether the specified value can be stored without changing the keys of other values.
+     *
+     * store(const T& value)
+     *      returns the key for the specified value, which must fit.
+     *
+     * load(const type& key)
+     *      returns the value of the specified key.
+     *
+     * release(const type& key)
+     *      records that the specified key is no longer used by any node.
+     *
+     * wasteful()
+     *      returns whether the memory used by released keys should be reclaimed by storing the keys
+     *      which are in use in an empty policy.
+     *
+     * empty()
+     *      returns a policy with the same options which stores no keys, and in which all values that
+     *      fit this policy fit.
+     *
+     * empty(const T& value)
+     *      returns an empty policy in which the specified value and all values that fit this policy fit.
+     *
+     * memory()
+     *      returns the memory used by the policy in bytes, excluding the keys in the nodes.
+     */
+
+
+    /**
+     * Stores integral values directly in the nodes.
+     */
+    template <class T>
+    class PackedKeys {
+        static_assert(is_integral<T>::value, "PackedKeys requires an integral type or string");
+        
+        public:
+            using type = T;
+            using query = T;
+            
+            query prepare(const T& value) const {
+                return value;
+            }
+            
+            /**
+             * Returns the three-way comparison of the specified values without branching.
+             */
+            int compare(const query& query, const type& key) const {
+                return (query > key) - (query < key);
+            }
+            
+            bool fits(const T&) const {
+                return true;
+            }
+            
+            type store(const T& value) {
+                return value;
+            }
+            
+            T load(const type& key) const {
+                return key;
+            }
+            
+            void release(const type& key) {}
+            
+            bool wasteful() const {
+                return false;
+            }
+            
+            PackedKeys<T> empty() const {
+                return PackedKeys<T>();
+            }
+            
+            PackedKeys<T> empty(const T&) const {
+                return PackedKeys<T>();
+            }
+            
+            size_t memory() const {
+                return 0;
+            }
+    };
+
+
+    /**
+     * Stores strings by stripping the longest prefix which is common to all strings, such as the scheme 
+     * and host of URLs, and storing the next 8 bytes inline in the nodes as a big-endian integer, so that 
+     * most comparisons are resolved without reading the rest of the string. The rest of each string is 
+     * stored contiguously in an arena.
+     * 
+     * The common prefix only ever shortens. A string which does not start with the common prefix does not
+     * fit, and the tree then moves all keys into a policy with a shorter common prefix.
+     * 
+     * The bytes of removed strings are reclaimed once they make up more than half of the arena. If 
+     * interning is enabled, the bytes of removed strings are instead kept and reused if an equal string is
+     * stored again, which avoids reclaiming memory when the same strings are repeatedly removed and added.
+     */
+    template <>
+    class PackedKeys<string> {
+        public:
+            /**
+             * Represents the rest of a string after the common prefix, which is stored in the arena.
+             */
+            struct type {
+                uint64_t prefix;
+                uint32_t offset;
+                uint32_t length;
+            };
+            
+            /**
+             * Represents a string which has been prepared for comparison. If the string does not start with 
+             * the common prefix, the bias is -1 or 1 if it is respectively smaller or larger than all strings.
+             */
+            struct query {
+                uint64_t prefix;
+                const char* data;
+                size_t length;
+                int bias;
+            };
+        
+        private:
+            /**
+             * Represents an interned string, which is absent if the offset is UINT32_MAX.
+             */
+            struct Entry {
+                uint64_t digest;
+                uint32_t offset;
+                uint32_t length;
+            };
+            
+            string common;
+            bool started;
+            vector<char> arena;
+            vector<Entry> entries;
+            size_t interned;
+            size_t garbage;
+            bool interning;
+            
+            /**
+             * Returns the first 8 bytes of the specified string as a big-endian integer, padded with 0.
+             * 
+             * @param data the string
+             * @param length the length of the string
+             * @return the prefix
+             */
+            static uint64_t prefix(const char* data, size_t length);
+            
+            /**
+             * Appends the specified string to the arena.
+             * 
+             * @param data the string
+             * @param length the length of the string
+             * @return the offset of the string
+             * @throws invalid_argument if the arena would exceed 4 GiB
+             */
+            uint32_t append(const char* data, size_t length);
+            
+            /**
+             * Doubles the number of entries and reinserts the interned strings.
+             */
+            void grow();
+        
+        public:
+            /**
+             * Constructs an empty PackedKeys<string>.
+             * 
+             * @param interning whether equal strings reuse the bytes of removed strings, or false if unspecified
+             */
+            PackedKeys(bool interning = false);
+            
+            query prepare(const string& value) const;
+            
+            int compare(const query& query, const type& key) const;
+            
+            bool fits(const string& value) const;
+            
+            type store(const string& value);
+            
+            string load(const type& key) const;
+            
+            void release(const type& key);
+            
+            bool wasteful() const;
+            
+            PackedKeys<string> empty() const;
+            
+            PackedKeys<string> empty(const string& value) const;
+            
+            size_t memory() const;
+    };
+
+    inline PackedKeys<string>::PackedKeys(bool interning) : started(false), interned(0), garbage(0), interning(interning) {
+        if (interning) {
+            entries = vector<Entry>(16, Entry {0, UINT32_MAX, 0});
+        }
+    }
+
+    inline uint64_t PackedKeys<string>::prefix(const char* data, size_t length) {
+        uint64_t prefix = 0;
+        for (size_t i = 0; i < 8; i++) {
+            prefix = (prefix << 8) | (i < length ? (unsigned char) data[i] : 0);
+        }
+        return prefix;
+    }
+
+    inline PackedKeys<string>::query PackedKeys<string>::prepare(const string& value) const {
+        auto skipped = common.size();
+        auto length = value.size() < skipped ? value.size() : skipped;
+        auto comparison = memcmp(value.data(), common.data(), length);
+        
+        if (comparison != 0 || value.size() < skipped) {
+            return query {0, value.data(), value.size(), comparison > 0 ? 1 : -1};
+        }
+        return query {prefix(value.data() + skipped, value.size() - skipped), value.data() + skipped, value.size() - skipped, 0};
+    }
+
+    inline int PackedKeys<string>::compare(const query& query, const type& key) const {
+        int comparison = (query.prefix > key.prefix) - (query.prefix < key.prefix);
+        if (query.bias != 0) {
+            return query.bias;
+        
+        } else if (comparison != 0) {
+            return comparison;
+        }
+        
+        size_t length = query.length < key.length ? query.length : key.length;
+        if (length > 8) {
+            comparison = memcmp(query.data + 8, &arena[key.offset + 8], length - 8);
+            if (comparison != 0) {
+                return comparison < 0 ? -1 : 1;
+            }
+        }
+        return (query.length > key.length) - (query.length < key.length);
+    }
+
+    inline bool PackedKeys<string>::fits(const string& value) const {
+        return started && value.compare(0, common.size(), common) == 0;
+    }
+
+    inline uint32_t PackedKeys<string>::append(const char* data, size_t length) {
+        if (arena.size() + length >= UINT32_MAX) {
+            throw invalid_argument("String arena is full");
+        }
+        
+        auto offset = (uint32_t) arena.size();
+        arena.insert(arena.end(), data, data + length);
+        return offset;
+    }
+
+    inline PackedKeys<string>::type PackedKeys<string>::store(const string& value) {
+        auto data = value.data() + common.size();
+        auto length = value.size() - common.size();
+        auto key = type {prefix(data, length), 0, (uint32_t) length};
+        if (!interning) {
+            key.offset = append(data, length);
+            return key;
+        }
+        
+        auto hash = digest(value);
+        auto mask = entries.size() - 1;
+        auto i = hash & mask;
+        for (; entries[i].offset != UINT32_MAX; i = (i + 1) & mask) {
+            auto& entry = entries[i];
+            if (entry.digest == hash && entry.length == length && memcmp(&arena[entry.offset], data, length) == 0) {
+                key.offset = entry.offset;
+                return key;
+            }
+        }
+        
+        key.offset = append(data, length);
+        entries[i] = Entry {hash, key.offset, key.length};
+        if (2 * ++interned > entries.size()) {
+            grow();
+        }
+        return key;
+    }
+
+    inline void PackedKeys<string>::grow() {
+        vector<Entry> old(entries.size() * 2, Entry {0, UINT32_MAX, 0});
+        old.swap(entries);
+        
+        auto mask = entries.size() - 1;
+        for (auto& entry : old) {
+            if (entry.offset != UINT32_MAX) {
+                auto i = entry.digest & mask;
+                while (entries[i].offset != UINT32_MAX) {
+                    i = (i + 1) & mask;
+                }
+                entries[i] = entry;
+            }
+        }
+    }
+
+    inline string PackedKeys<string>::load(const type& key) const {
+        return common + string(arena.data() + key.offset, key.length);
+    }
+
+    inline void PackedKeys<string>::release(const type& key) {
+        if (!interning) {
+            garbage += key.length;
+        }
+    }
+
+    inline bool PackedKeys<string>::wasteful() const {
+        return garbage > 4096 && garbage > arena.size() / 2;
+    }
+
+    inline PackedKeys<string> PackedKeys<string>::empty() const {
+        PackedKeys<string> keys(interning);
+        keys.common = common;
+        keys.started = started;
+        return keys;
+    }
+
+    inline PackedKeys<string> PackedKeys<string>::empty(const string& value) const {
+        auto keys = empty();
+        if (!started) {
+            keys.common = value;
+            keys.started = true;
+            return keys;
+        }
+        
+        size_t length = 0;
+        while (length < common.size() && length < value.size() && common[length] == value[length]) {
+            length++;
+        }
+        keys.common.resize(length);
+        return keys;
+    }
+
+    inline size_t PackedKeys<string>::memory() const {
+        return common.capacity() + arena.capacity() + entries.capacity() * sizeof(Entry);
+    }
+
+}
+
+#endif /* KEYS_H */
@@ -34,6 +34,8 @@
 #define NODE_H
 
 #include <memory>
+#include <ostream>
+#include <utility>
 
 using namespace std;
 
@@ -55,19 +57,22 @@ namespace assignment {
               
         
         /**
-         * Constructs a Node with the specified value and reference to its parent.
+         * Constructs a Node with a copy of the specified value and reference to its parent.
          * 
          * @param value the value
          * @param parent the parent for the node, or null if unspecified
          */
-        Node(T value, shared_ptr<Node<T>> parent = shared_ptr<Node<T>>(nullptr)) {
-            this->value = value;
-            amount = 1;
-            balance = 0;
-            this->parent = parent;
-            left = shared_ptr<Node<T>>(nullptr);
-            right = shared_ptr<Node<T>>(nullptr);
-        }
+        Node(const T& value, shared_ptr<Node<T>> parent = shared_ptr<Node<T>>(nullptr))
+            : value(value), amount(1), balance(0), parent(parent) {}
+        
+        /**
+         * Constructs a Node which takes ownership of the specified value and reference to its parent.
+         * 
+         * @param value the value
+         * @param parent the parent for the node, or null if unspecified
+         */
+        Node(T&& value, shared_ptr<Node<T>> parent = shared_ptr<Node<T>>(nullptr))
+            : value(std::move(value)), amount(1), balance(0), parent(parent) {}
 
         /**
          * Displays the specified node using the specified ostream.
@@ -84,32 +89,6 @@ namespace assignment {
             
     };
     
-    /**
-     * Replaces the specified target using the specified source with the exception of the parent node.
-     * 
-     * @param the source the source which is used to replace the target
-     * @param the target the target which is to be replaced
-     */
-    template <class T>
-    void replace(shared_ptr<Node<T>> source, shared_ptr<Node<T>> target) {
-        auto left = source->left;
-        auto right = source ->right;
-        
-        target->balance = source->balance;
-        target->value = source->value;
-        target->amount = source->amount;
-        target->left = left;
-        target->right = right;
-        
-        if (left) {
-            left->parent = target;
-        }
-        
-        if (right) {
-            right->parent = target;
-        }
-    }
-    
 }
 
 #endif /* NODE_H */
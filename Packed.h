@@ -0,0 +1,813 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2018 PohSeng#1.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   Packed.h
+ * Author: Matthias Ngeo - S10172190F
+ * Author: Francis Koh - S10172072G
+ *
+ * Created on February 3, 2018, 2:10 PM
+ */
+
+#ifndef PACKED_H
+#define PACKED_H
+
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Keys.h"
+#include "Tree.h"
+
+using namespace std;
+
+namespace assignment {
+
+    /**
+     * Represents a node of a PackedAVLTree with the specified type of key. The children are indexes of 
+     * other nodes, where 0 represents the absence of a child. The amount and the balance share 32 bits: 
+     * the lower 2 bits hold the balance plus 1, and the upper 30 bits hold the amount.
+     */
+    template <class K>
+    struct PackedNode {
+        K key;
+        uint32_t children[2];
+        uint32_t meta;
+    };
+
+
+    /**
+     * Represents an AVL tree of integral values or strings which stores its nodes contiguously in a vector. 
+     * The values are stored in the nodes using PackedKeys<T>, which keeps strings in an arena and only their 
+     * first 8 bytes in the nodes.
+     * 
+     * Nodes refer to their children by 32-bit indexes instead of shared pointers, and do not refer to 
+     * their parents. Instead, the nodes which are visited while descending are kept in an explicit path, 
+     * which is used to balance the tree afterwards. Compared to AVLTree<T>, a node of a PackedAVLTree<int> 
+     * uses 16 bytes instead of more than 70 bytes, and is neither allocated nor reference counted 
+     * individually. The nodes of removed values are reused by subsequent additions.
+     * 
+     * A value may be added at most 2^30 - 1 times.
+     */
+    template <class T>
+    class PackedAVLTree {
+        private:
+            using Key = typename PackedKeys<T>::type;
+            
+            /**
+             * The maximum height of the tree, which is larger than the height of an AVL tree with 2^32 nodes.
+             */
+            static const int DEPTH = 64;
+            
+            PackedKeys<T> keys;
+            vector<PackedNode<Key>> slots;
+            uint32_t root;
+            uint32_t available;
+            int values;
+            int total;
+            
+            /**
+             * Returns the balance of the specified node.
+             * 
+             * @param node the node
+             * @return the height of the right subtree minus the height of the left subtree
+             */
+            int balance(uint32_t node) const;
+            
+            /**
+             * Sets the balance of the specified node.
+             * 
+             * @param node the node
+             * @param balance the balance, between -1 and 1
+             */
+            void balance(uint32_t node, int balance);
+            
+            /**
+             * Returns the amount of the specified node.
+             * 
+             * @param node the node
+             * @return the amount
+             */
+            uint32_t count(uint32_t node) const;
+            
+            /**
+             * Sets the amount of the specified node.
+             * 
+             * @param node the node
+             * @param amount the amount
+             * @throws invalid_argument if the amount is not less than 2^30
+             */
+            void count(uint32_t node, uint32_t amount);
+            
+            /**
+             * Returns the node which contains the specified value.
+             * 
+             * @implSpec
+             * Compares the value with each node using a branchless three-way comparison, which selects
+             * the child to descend to by index instead of by branching.
+             * 
+             * @param value the value
+             * @return the node, or 0 if the tree does not contain the value
+             */
+            uint32_t find(const T& value) const;
+            
+            /**
+             * Creates a node with the specified value, reusing the node of a removed value if any.
+             * 
+             * @param value the value
+             * @return the created node
+             */
+            uint32_t allocate(const T& value);
+            
+            /**
+             * Releases the specified node for reuse.
+             * 
+             * @param node the node
+             */
+            void release(uint32_t node);
+            
+            /**
+             * Replaces the child of the node at the specified depth of the path, or the root if the depth is 0,
+             * with the specified node.
+             * 
+             * @param path the nodes from the root
+             * @param directions the direction taken from each node, where 0 is left and 1 is right
+             * @param depth the depth of the child to replace
+             * @param node the replacement
+             */
+            void link(const uint32_t* path, const int* directions, int depth, uint32_t node);
+            
+            /**
+             * Lifts the child of the specified node in the specified direction above the node.
+             * Balances are left unchanged.
+             * 
+             * @param node the node to rotate
+             * @param direction the direction of the child, where 0 is left and 1 is right
+             * @return the lifted child
+             */
+            uint32_t lift(uint32_t node, int direction);
+            
+            /**
+             * Balances the subtree of the specified node, whose balance is -2 or 2, using a single rotation 
+             * if its taller child leans in the same direction or is balanced; else a double rotation.
+             * 
+             * @param node the node
+             * @param balance the balance of the node, either -2 or 2
+             * @return the root of the subtree after balancing
+             */
+            uint32_t rebalance(uint32_t node, int balance);
+            
+            /**
+             * Moves the keys of all nodes into the specified empty key policy, which replaces the current
+             * key policy. This reclaims the memory used by the keys of removed values.
+             * 
+             * @param keys the empty key policy
+             */
+            void rekey(PackedKeys<T> keys);
+            
+            /**
+             * Calls the specified function with each node in ascending order while it returns true.
+             * 
+             * @implSpec
+             * Iterates through the nodes using a stack of the nodes whose left subtrees are being visited.
+             * 
+             * @param function the function to call with each node
+             */
+            template <class Function>
+            void walk(Function function) const;
+        
+        public:
+            /**
+             * Constructs an empty PackedAVLTree which stores its values using the specified key policy.
+             * 
+             * @param keys the key policy, such as PackedKeys<string>(true) to intern strings, 
+             *        or the default policy if unspecified
+             */
+            PackedAVLTree(PackedKeys<T> keys = PackedKeys<T>());
+            
+            PackedAVLTree(const PackedAVLTree<T>& other) = default;
+            
+            /**
+             * Constructs a PackedAVLTree which takes over the nodes and keys of the specified tree, leaving
+             * it empty with the same key policy options.
+             * 
+             * @param other the tree to move
+             */
+            PackedAVLTree(PackedAVLTree<T>&& other);
+            
+            PackedAVLTree<T>& operator=(const PackedAVLTree<T>& other) = default;
+            
+            /**
+             * Replaces the values in this tree with the nodes and keys of the specified tree, leaving it
+             * empty with the same key policy options.
+             * 
+             * @param other the tree to move
+             * @return this
+             */
+            PackedAVLTree<T>& operator=(PackedAVLTree<T>&& other);
+            
+            /**
+             * Removes all values from the tree.
+             */
+            void clear();
+            
+            /**
+             * Returns the height of the tree, which is the number of levels in the tree.
+             * 
+             * @return the height of the tree, or 0 if the tree is empty
+             */
+            int height() const;
+            
+            /**
+             * Returns the memory used by the tree, including the memory used by the key policy. 
+             * Reserved nodes which are not in use are counted as overhead.
+             * 
+             * @return the memory used by the tree
+             */
+            Memory memory_usage() const;
+            
+            /**
+             * Adds the specified value the specified number of times.
+             * 
+             * @implSpec
+             * Delegates to #rekey(PackedKeys<T> keys) if the value does not fit the key policy. Afterwards 
+             * iterates through the nodes in the tree starting from the root while recording the path taken,
+             * and creates a node if the tree does not contain the value. Afterwards iterates through the path
+             * in reverse, updating the balances until the height of a subtree is unchanged or a subtree has
+             * been rotated. Hence, adding a value any number of times takes O(log(n)) time.
+             * 
+             * @param value the value to add
+             * @param amount the number of times to add the value, or 1 if unspecified
+             * @throws invalid_argument if the amount is less than 1, or the value would be added 2^30 or more times
+             * @return this
+             */
+            PackedAVLTree<T>& add(const T& value, int amount = 1);
+            
+            /**
+             * Removes the specified value.
+             * 
+             * @implSpec
+             * Iterates through the nodes in the tree starting from the root while recording the path taken.
+             * If the node which contains the value has both a left and right child, the value and amount of 
+             * its successor are moved into it, and the successor is removed instead. Afterwards iterates 
+             * through the path in reverse, updating the balances until the height of a subtree is unchanged.
+             * Delegates to #rekey(PackedKeys<T> keys) if the key policy holds too many keys of removed values.
+             * 
+             * @param value the value to remove
+             * @return true if the value was successfully removed; else false
+             */
+            bool remove(const T& value);
+            
+            /**
+             * Returns whether the tree contains the specified value.
+             * 
+             * @param value the value
+             * @return true if the tree contains the specified value; else false
+             */
+            bool contains(const T& value) const;
+            
+            /**
+             * Returns whether the tree contains the specified value, displaying the path taken.
+             * 
+             * @param value the value
+             * @param stream the ostream used to display the path taken
+             * @return true if the tree contains the specified value; else false
+             */
+            bool contains(const T& value, ostream& stream) const;
+            
+            /**
+             * Returns the number of times the specified value occurs in the tree.
+             * 
+             * @param value the value
+             * @return the amount of the value, or 0 if the tree does not contain it
+             */
+            int amount(const T& value) const;
+            
+            /**
+             * Returns the value of the node at the specified index in level-by-level order.
+             * 
+             * @param index the index of the node
+             * @throws invalid_argument if the specified index is less than 0 or not less than the number of nodes
+             * @return the value of the node at the specified index
+             */
+            T operator[](int index) const;
+            
+            /**
+             * Returns the value of the node at the specified index in ascending order, excluding duplicate values.
+             * 
+             * @param index the index of the node
+             * @throws invalid_argument if the specified index is less than 0 or not less than the number of nodes
+             * @return the value of the node at the specified index
+             */
+            T select(int index) const;
+            
+            /**
+             * Calls the specified function with each value and its amount in ascending order.
+             * 
+             * @param function the function to call with each value and amount
+             */
+            template <class Function>
+            void for_each(Function function) const;
+            
+            /**
+             * Displays the values of the specified tree in ascending order using the specified ostream.
+             * 
+             * @param stream the ostream used to display the tree
+             * @param tree the tree to display
+             * @return the ostream
+             */
+            template <class V>
+            friend ostream& operator<<(ostream& stream, const PackedAVLTree<V>& tree);
+            
+            /**
+             * Returns the number of nodes in the tree.
+             * 
+             * @return the number of nodes in the tree, excluding duplicate values
+             */
+            int nodes() const;
+            
+            /**
+             * Returns the number of values in the tree.
+             * 
+             * @return the number of values in the tree, including duplicate values
+             */
+            int size() const;
+    };
+
+    template <class T>
+    PackedAVLTree<T>::PackedAVLTree(PackedKeys<T> keys) : keys(std::move(keys)) {
+        clear();
+    }
+
+    template <class T>
+    PackedAVLTree<T>::PackedAVLTree(PackedAVLTree<T>&& other) : PackedAVLTree(other.keys.empty()) {
+        *this = std::move(other);
+    }
+
+    template <class T>
+    PackedAVLTree<T>& PackedAVLTree<T>::operator=(PackedAVLTree<T>&& other) {
+        if (this != &other) {
+            auto empty = other.keys.empty();
+            
+            keys = std::move(other.keys);
+            slots = std::move(other.slots);
+            root = other.root;
+            available = other.available;
+            values = other.values;
+            total = other.total;
+            
+            other.keys = std::move(empty);
+            other.clear();
+        }
+        return *this;
+    }
+
+    template <class T>
+    void PackedAVLTree<T>::clear() {
+        keys = keys.empty();
+        slots.assign(1, PackedNode<Key> {Key(), {0, 0}, 0});
+        root = 0;
+        available = 0;
+        values = 0;
+        total = 0;
+    }
+
+    template <class T>
+    int PackedAVLTree<T>::balance(uint32_t node) const {
+        return (int) (slots[node].meta & 3) - 1;
+    }
+
+    template <class T>
+    void PackedAVLTree<T>::balance(uint32_t node, int balance) {
+        slots[node].meta = (slots[node].meta & ~3U) | (uint32_t) (balance + 1);
+    }
+
+    template <class T>
+    uint32_t PackedAVLTree<T>::count(uint32_t node) const {
+        return slots[node].meta >> 2;
+    }
+
+    template <class T>
+    void PackedAVLTree<T>::count(uint32_t node, uint32_t amount) {
+        if (amount >= (1U << 30)) {
+            throw invalid_argument("Amount exceeds the maximum of a packed node");
+        }
+        slots[node].meta = (amount << 2) | (slots[node].meta & 3);
+    }
+
+    template <class T>
+    uint32_t PackedAVLTree<T>::find(const T& value) const {
+        auto query = keys.prepare(value);
+        auto node = root;
+        while (node) {
+            auto& current = slots[node];
+            int comparison = keys.compare(query, current.key);
+            if (comparison == 0) {
+                return node;
+            }
+            node = current.children[comparison > 0];
+        }
+        return 0;
+    }
+
+    template <class T>
+    uint32_t PackedAVLTree<T>::allocate(const T& value) {
+        auto node = available;
+        if (node) {
+            available = slots[node].children[0];
+        
+        } else if (slots.size() < UINT32_MAX) {
+            node = slots.size();
+            slots.push_back(PackedNode<Key>());
+        
+        } else {
+            throw invalid_argument("Tree is full");
+        }
+        
+        slots[node] = PackedNode<Key> {keys.store(value), {0, 0}, (1U << 2) | 1};
+        return node;
+    }
+
+    template <class T>
+    void PackedAVLTree<T>::release(uint32_t node) {
+        slots[node].children[0] = available;
+        available = node;
+    }
+
+    template <class T>
+    void PackedAVLTree<T>::link(const uint32_t* path, const int* directions, int depth, uint32_t node) {
+        if (depth == 0) {
+            root = node;
+        
+        } else {
+            slots[path[depth - 1]].children[directions[depth - 1]] = node;
+        }
+    }
+
+    template <class T>
+    uint32_t PackedAVLTree<T>::lift(uint32_t node, int direction) {
+        auto child = slots[node].children[direction];
+        slots[node].children[direction] = slots[child].children[1 - direction];
+        slots[child].children[1 - direction] = node;
+        return child;
+    }
+
+    template <class T>
+    uint32_t PackedAVLTree<T>::rebalance(uint32_t node, int balance) {
+        int direction = balance > 0;
+        int sign = balance > 0 ? 1 : -1;
+        auto child = slots[node].children[direction];
+        auto leaning = this->balance(child) * sign;
+        
+        if (leaning >= 0) {
+            auto top = lift(node, direction);
+            auto lower = 1 - leaning;
+            this->balance(node, lower * sign);
+            this->balance(top, (leaning - 1 + (lower < 0 ? lower : 0)) * sign);
+            return top;
+        }
+        
+        auto grandchild = slots[child].children[1 - direction];
+        auto inner = this->balance(grandchild) * sign;
+        slots[node].children[direction] = lift(child, 1 - direction);
+        auto top = lift(node, direction);
+        
+        this->balance(node, inner > 0 ? -sign : 0);
+        this->balance(child, inner < 0 ? sign : 0);
+        this->balance(top, 0);
+        return top;
+    }
+
+    template <class T>
+    int PackedAVLTree<T>::height() const {
+        int height = 0;
+        for (auto node = root; node; height++) {
+            node = slots[node].children[balance(node) >= 0];
+        }
+        return height;
+    }
+
+    template <class T>
+    Memory PackedAVLTree<T>::memory_usage() const {
+        Memory memory;
+        memory.nodes = values * sizeof(PackedNode<Key>) + keys.memory();
+        memory.overhead = (slots.capacity() - values) * sizeof(PackedNode<Key>);
+        memory.scratch = values * sizeof(uint32_t);
+        memory.indexes = 0;
+        return memory;
+    }
+
+    template <class T>
+    PackedAVLTree<T>& PackedAVLTree<T>::add(const T& value, int amount) {
+        if (amount < 1 || amount >= (1 << 30)) {
+            throw invalid_argument("Amount must be at least 1 and less than 2^30");
+        }
+        
+        if (!keys.fits(value)) {
+            rekey(keys.empty(value));
+        }
+        
+        if (!root) {
+            auto added = allocate(value);
+            count(added, amount);
+            root = added;
+            values++;
+            total += amount;
+            return *this;
+        }
+        
+        uint32_t path[DEPTH];
+        int directions[DEPTH];
+        int depth = 0;
+        
+        auto query = keys.prepare(value);
+        for (auto node = root; node; depth++) {
+            auto& current = slots[node];
+            int comparison = keys.compare(query, current.key);
+            if (comparison == 0) {
+                count(node, count(node) + (uint32_t) amount);
+                total += amount;
+                return *this;
+            }
+            
+            path[depth] = node;
+            directions[depth] = comparison > 0;
+            node = current.children[directions[depth]];
+        }
+        
+        auto added = allocate(value);
+        count(added, amount);
+        slots[path[depth - 1]].children[directions[depth - 1]] = added;
+        values++;
+        total += amount;
+        
+        for (int i = depth - 1; i >= 0; i--) {
+            auto node = path[i];
+            auto balance = this->balance(node) + (directions[i] ? 1 : -1);
+            if (balance == 0) {
+                this->balance(node, 0);
+                break;
+            
+            } else if (balance == 1 || balance == -1) {
+                this->balance(node, balance);
+            
+            } else {
+                link(path, directions, i, rebalance(node, balance));
+                break;
+            }
+        }
+        
+        return *this;
+    }
+
+    template <class T>
+    bool PackedAVLTree<T>::remove(const T& value) {
+        uint32_t path[DEPTH];
+        int directions[DEPTH];
+        int depth = 0;
+        
+        auto query = keys.prepare(value);
+        auto node = root;
+        int comparison;
+        while (node && (comparison = keys.compare(query, slots[node].key)) != 0) {
+            path[depth] = node;
+            directions[depth] = comparison > 0;
+            node = slots[node].children[directions[depth++]];
+        }
+        
+        if (!node) {
+            return false;
+        
+        } else if (count(node) > 1) {
+            count(node, count(node) - 1);
+            total--;
+            return true;
+        }
+        
+        keys.release(slots[node].key);
+        if (slots[node].children[0] && slots[node].children[1]) {
+            auto target = node;
+            path[depth] = node;
+            directions[depth++] = 1;
+            node = slots[node].children[1];
+            
+            while (slots[node].children[0]) {
+                path[depth] = node;
+                directions[depth++] = 0;
+                node = slots[node].children[0];
+            }
+            
+            slots[target].key = slots[node].key;
+            count(target, count(node));
+        }
+        
+        auto child = slots[node].children[0] ? slots[node].children[0] : slots[node].children[1];
+        link(path, directions, depth, child);
+        release(node);
+        values--;
+        total--;
+        
+        for (int i = depth - 1; i >= 0; i--) {
+            auto node = path[i];
+            auto balance = this->balance(node) - (directions[i] ? 1 : -1);
+            if (balance == 1 || balance == -1) {
+                this->balance(node, balance);
+                break;
+            
+            } else if (balance == 0) {
+                this->balance(node, 0);
+            
+            } else {
+                auto top = rebalance(node, balance);
+                link(path, directions, i, top);
+                if (this->balance(top) != 0) {
+                    break;
+                }
+            }
+        }
+        
+        if (keys.wasteful()) {
+            rekey(keys.empty());
+        }
+        return true;
+    }
+
+    template <class T>
+    void PackedAVLTree<T>::rekey(PackedKeys<T> compacted) {
+        vector<uint32_t> stack;
+        if (root) {
+            stack.push_back(root);
+        }
+        
+        while (!stack.empty()) {
+            auto node = stack.back();
+            stack.pop_back();
+            
+            slots[node].key = compacted.store(keys.load(slots[node].key));
+            for (auto child : slots[node].children) {
+                if (child) {
+                    stack.push_back(child);
+                }
+            }
+        }
+        
+        keys = std::move(compacted);
+    }
+
+    template <class T>
+    bool PackedAVLTree<T>::contains(const T& value) const {
+        return find(value) != 0;
+    }
+
+    template <class T>
+    bool PackedAVLTree<T>::contains(const T& value, ostream& stream) const {
+        auto query = keys.prepare(value);
+        auto node = root;
+        if (root) {
+            stream << "Root" << endl;
+        }
+        
+        while (node) {
+            auto comparison = keys.compare(query, slots[node].key);
+            if (comparison > 0) {
+                node = slots[node].children[1];
+                stream << "Right" << endl;
+            
+            } else if (comparison < 0) {
+                node = slots[node].children[0];
+                stream << "Left" << endl;
+            
+            } else {
+                return true;
+            }
+        }
+        
+        return false;
+    }
+
+    template <class T>
+    int PackedAVLTree<T>::amount(const T& value) const {
+        auto node = find(value);
+        return node ? count(node) : 0;
+    }
+
+    template <class T>
+    T PackedAVLTree<T>::operator[](int index) const {
+        if (index < 0 || index >= values) {
+            throw invalid_argument("index is invalid");
+        }
+        
+        vector<uint32_t> queue;
+        queue.reserve(index + 1);
+        queue.push_back(root);
+        for (size_t i = 0; (int) i < index; i++) {
+            for (auto child : slots[queue[i]].children) {
+                if (child) {
+                    queue.push_back(child);
+                }
+            }
+        }
+        
+        return keys.load(slots[queue[index]].key);
+    }
+
+    template <class T>
+    T PackedAVLTree<T>::select(int index) const {
+        if (index < 0 || index >= values) {
+            throw invalid_argument("index is invalid");
+        }
+        
+        uint32_t selected = 0;
+        walk([&index, &selected](uint32_t node) {
+            selected = node;
+            return index-- > 0;
+        });
+        return keys.load(slots[selected].key);
+    }
+
+    template <class T>
+    template <class Function>
+    void PackedAVLTree<T>::for_each(Function function) const {
+        walk([this, &function](uint32_t node) {
+            function(keys.load(slots[node].key), (int) count(node));
+            return true;
+        });
+    }
+
+    template <class T>
+    template <class Function>
+    void PackedAVLTree<T>::walk(Function function) const {
+        vector<uint32_t> stack;
+        auto node = root;
+        
+        while (node || !stack.empty()) {
+            if (node) {
+                stack.push_back(node);
+                node = slots[node].children[0];
+            
+            } else {
+                node = stack.back();
+                stack.pop_back();
+                
+                if (!function(node)) {
+                    return;
+                }
+                node = slots[node].children[1];
+            }
+        }
+    }
+
+    template <class T>
+    ostream& operator<<(ostream& stream, const PackedAVLTree<T>& tree) {
+        tree.for_each([&stream](const T& value, int amount) {
+            for (int i = 0; i < amount; i++) {
+                stream << value << endl;
+            }
+        });
+        return stream;
+    }
+
+    template <class T>
+    int PackedAVLTree<T>::nodes() const {
+        return values;
+    }
+
+    template <class T>
+    int PackedAVLTree<T>::size() const {
+        return total;
+    }
+
+
+    /**
+     * Selects PackedAVLTree for integral values and strings, and AVLTree otherwise at compile time.
+     */
+    template <class T>
+    using TreeOf = typename conditional<is_integral<T>::value || is_same<T, string>::value, PackedAVLTree<T>, AVLTree<T>>::type;
+
+}
+
+#endif /* PACKED_H */
@@ -0,0 +1,304 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2018 PohSeng#1.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   Pool.h
+ * Author: Matthias Ngeo - S10172190F
+ * Author: Francis Koh - S10172072G
+ *
+ * Created on February 5, 2018, 11:30 AM
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace assignment {
+
+    /**
+     * Represents a pool of threads which execute tasks using work stealing. Each thread has its own
+     * queue of tasks, from which it takes the most recently submitted task. A thread without tasks steals
+     * the least recently submitted task of another thread, which is typically the largest remaining task
+     * when tasks are split recursively.
+     *
+     * Threads which wait for a task to complete execute other tasks in the meantime, so tasks may wait
+     * for the tasks they submit without exhausting the threads of the pool.
+     */
+    class ThreadPool {
+        private:
+            /**
+             * Represents the queue of tasks of a thread.
+             */
+            struct Worker {
+                mutex lock;
+                deque<function<void()>> tasks;
+            };
+            
+            vector<unique_ptr<Worker>> workers;
+            vector<thread> threads;
+            atomic<int> queued;
+            atomic<bool> stopping;
+            atomic<unsigned> next;
+            mutex sleeping;
+            condition_variable wakeup;
+            
+            /**
+             * Returns the index of the worker of the current thread in this pool.
+             *
+             * @return the index of the worker, or -1 if the current thread does not belong to this pool
+             */
+            int self() const;
+            
+            /**
+             * Returns the pool to which the current thread belongs and the index of its worker.
+             *
+             * @return the pool and index of the worker of the current thread
+             */
+            static pair<const ThreadPool*, int>& current();
+            
+            /**
+             * Executes a task of the specified worker, or a task stolen from another worker if the
+             * specified worker has no tasks.
+             *
+             * @param index the index of the worker, or -1 to only steal
+             * @return true if a task was executed; else false
+             */
+            bool execute(int index);
+            
+            /**
+             * Executes tasks on the current thread until the pool is destroyed.
+             *
+             * @param index the index of the worker of the current thread
+             */
+            void work(int index);
+        
+        public:
+            /**
+             * Constructs a ThreadPool with the specified number of threads.
+             *
+             * @param threads the number of threads, or the number of hardware threads if unspecified
+             */
+            ThreadPool(int threads = (int) thread::hardware_concurrency());
+            
+            ThreadPool(const ThreadPool& other) = delete;
+            
+            ThreadPool& operator=(const ThreadPool& other) = delete;
+            
+            /**
+             * Stops and joins the threads of the pool. Tasks which have not started are discarded.
+             */
+            ~ThreadPool();
+            
+            /**
+             * Returns a pool shared by the library with a thread per hardware thread, which is created when
+             * first used.
+             *
+             * @return the shared pool
+             */
+            static ThreadPool& shared();
+            
+            /**
+             * Submits the specified task, which is added to the queue of the current thread if it belongs to
+             * this pool; else to the queue of a thread in turn.
+             *
+             * @param task the task
+             */
+            void submit(function<void()> task);
+            
+            /**
+             * Executes the specified functions in parallel, by submitting the second function and executing
+             * the first function on the current thread. Returns after both functions have completed, executing
+             * other tasks in the meantime.
+             *
+             * @param first the function to execute on the current thread
+             * @param second the function to submit
+             * @throws the exception thrown by the first function, or else by the second function, if any
+             */
+            template <class First, class Second>
+            void join(First first, Second second);
+            
+            /**
+             * Returns the number of threads in the pool.
+             *
+             * @return the number of threads
+             */
+            int size() const;
+    };
+
+    inline ThreadPool::ThreadPool(int threads) : queued(0), stopping(false), next(0) {
+        threads = threads > 0 ? threads : 1;
+        for (int i = 0; i < threads; i++) {
+            workers.emplace_back(new Worker());
+        }
+        for (int i = 0; i < threads; i++) {
+            this->threads.emplace_back(&ThreadPool::work, this, i);
+        }
+    }
+
+    inline ThreadPool::~ThreadPool() {
+        {
+            lock_guard<mutex> guard(sleeping);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    inline ThreadPool& ThreadPool::shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    inline pair<const ThreadPool*, int>& ThreadPool::current() {
+        static thread_local pair<const ThreadPool*, int> current(nullptr, -1);
+        return current;
+    }
+
+    inline int ThreadPool::self() const {
+        auto& current = ThreadPool::current();
+        return current.first == this ? current.second : -1;
+    }
+
+    inline void ThreadPool::submit(function<void()> task) {
+        auto index = self();
+        if (index < 0) {
+            index = next++ % workers.size();
+        }
+        
+        {
+            lock_guard<mutex> guard(workers[index]->lock);
+            workers[index]->tasks.push_back(std::move(task));
+        }
+        queued++;
+        
+        {
+            lock_guard<mutex> guard(sleeping);
+        }
+        wakeup.notify_one();
+    }
+
+    inline bool ThreadPool::execute(int index) {
+        function<void()> task;
+        if (index >= 0) {
+            lock_guard<mutex> guard(workers[index]->lock);
+            auto& tasks = workers[index]->tasks;
+            if (!tasks.empty()) {
+                task = std::move(tasks.back());
+                tasks.pop_back();
+            }
+        }
+        
+        int start = index >= 0 ? index + 1 : (int) (next % workers.size());
+        for (size_t i = 0; !task && i < workers.size(); i++) {
+            auto& victim = *workers[(start + i) % workers.size()];
+            lock_guard<mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+            }
+        }
+        
+        if (!task) {
+            return false;
+        }
+        
+        queued--;
+        task();
+        return true;
+    }
+
+    inline void ThreadPool::work(int index) {
+        current() = make_pair(this, index);
+        while (true) {
+            if (execute(index)) {
+                continue;
+            }
+            
+            unique_lock<mutex> lock(sleeping);
+            wakeup.wait(lock, [this]() {
+                return queued > 0 || stopping;
+            });
+            
+            if (stopping) {
+                return;
+            }
+        }
+    }
+
+    template <class First, class Second>
+    void ThreadPool::join(First first, Second second) {
+        atomic<bool> done(false);
+        exception_ptr submitted;
+        submit([&second, &done, &submitted]() {
+            try {
+                second();
+            } catch (...) {
+                submitted = current_exception();
+            }
+            done = true;
+        });
+        
+        exception_ptr executed;
+        try {
+            first();
+        } catch (...) {
+            executed = current_exception();
+        }
+        
+        auto index = self();
+        while (!done) {
+            if (!execute(index)) {
+                this_thread::yield();
+            }
+        }
+        
+        if (executed) {
+            rethrow_exception(executed);
+        
+        } else if (submitted) {
+            rethrow_exception(submitted);
+        }
+    }
+
+    inline int ThreadPool::size() const {
+        return workers.size();
+    }
+
+}
+
+#endif /* POOL_H */
@@ -34,6 +34,7 @@
 #define QUEUE_H
 
 #include <stdexcept>
+#include <utility>
 
 using namespace std;
 
@@ -49,14 +50,18 @@ namespace assignment {
         QueueNode<T>* previous;
         
         /**
-         * Constructs a QueueNode with the specified value and no reference to the previous node.
+         * Constructs a QueueNode with a copy of the specified value and no reference to the previous node.
          * 
          * @param value the value
          */
-        QueueNode(T value) {
-            this->value = value;
-            this->previous = nullptr;
-        }
+        QueueNode(const T& value) : value(value), previous(nullptr) {}
+        
+        /**
+         * Constructs a QueueNode which takes ownership of the specified value and no reference to the previous node.
+         * 
+         * @param value the value
+         */
+        QueueNode(T&& value) : value(std::move(value)), previous(nullptr) {}
         
     };
     
@@ -72,18 +77,41 @@ namespace assignment {
             QueueNode<T>* tail;
             int size;
             
+            /**
+             * Links the specified node at the tail of the queue.
+             * 
+             * @param node the node to link
+             */
+            void link(QueueNode<T>* node);
+            
         public:
             /**
              * Constructs an empty Queue.
              */
             Queue();
             
+            Queue(const Queue<T>&) = delete;
+            
+            Queue<T>& operator=(const Queue<T>&) = delete;
+            
+            /**
+             * Destroys the Queue and the elements which remain in it.
+             */
+            ~Queue();
+            
             /**
-             * Adds the specified element at the tail of the queue.
+             * Adds a copy of the specified element at the tail of the queue.
              * 
              * @param element the item to add 
              */
-            void push(T& element);
+            void push(const T& element);
+            
+            /**
+             * Moves the specified element to the tail of the queue.
+             * 
+             * @param element the item to add 
+             */
+            void push(T&& element);
             
             /**
              * Removes the element at the head of the queue.
@@ -114,8 +142,24 @@ namespace assignment {
     }
     
     template <class T>
-    void Queue<T>::push(T& element) {
-        auto node = new QueueNode<T>(element);
+    Queue<T>::~Queue() {
+        while (size > 0) {
+            pop();
+        }
+    }
+    
+    template <class T>
+    void Queue<T>::push(const T& element) {
+        link(new QueueNode<T>(element));
+    }
+    
+    template <class T>
+    void Queue<T>::push(T&& element) {
+        link(new QueueNode<T>(std::move(element)));
+    }
+    
+    template <class T>
+    void Queue<T>::link(QueueNode<T>* node) {
         if (size == 0) {
             head = node;
             tail = node;
@@ -139,7 +183,6 @@ namespace assignment {
             
         } else if (size == 1) {
             delete head;
-            delete tail;
             head = nullptr;
             tail = nullptr;
             
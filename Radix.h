@@ -0,0 +1,560 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2018 PohSeng#1.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   Radix.h
+ * Author: Matthias Ngeo - S10172190F
+ * Author: Francis Koh - S10172072G
+ *
+ * Created on February 5, 2018, 7:50 PM
+ */
+
+#ifndef RADIX_H
+#define RADIX_H
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "Packed.h"
+
+using namespace std;
+
+namespace assignment {
+
+    /**
+     * Represents an ordered multiset of integral values which are routed by the specified number of their 
+     * highest bits within the expected range of values into a direct-mapped array of buckets, where each 
+     * bucket holds the values sharing those bits. Values outside the expected range are kept in the first 
+     * and last buckets. A bucket holds its distinct values and their amounts in a sorted array, which is replaced by a
+     * PackedAVLTree once it holds more than #SORTED values, so that skewed keys do not degrade additions.
+     * 
+     * Since every value in a bucket is smaller than every value in the next bucket, ordered operations visit
+     * the buckets in order. For dense keys, each bucket holds n / 2^BITS values. A bucket of at most #SORTED
+     * values is binary searched within a few cache lines, and a larger bucket is descended as a tree, so that
+     * a lookup of 100 million 32-bit keys with 16 bits descends about 11 levels of a bucket of about 1500
+     * values instead of 27 levels of a single tree.
+     * 
+     * The number of distinct values in each bucket is kept in a Fenwick tree, so that the bucket of the 
+     * value at an index is found in O(BITS) time.
+     */
+    template <class T, int BITS = 16>
+    class RadixTree {
+        static_assert(is_integral<T>::value, "RadixTree requires an integral type");
+        static_assert(0 < BITS && BITS <= 24 && BITS < (int) (sizeof(T) * CHAR_BIT), "RadixTree requires between 1 and 24 bits");
+        
+        private:
+            using Unsigned = typename make_unsigned<T>::type;
+            
+            static const int BUCKETS = 1 << BITS;
+            
+            /**
+             * The maximum number of distinct values in the sorted array of a bucket.
+             */
+            static const size_t SORTED = 256;
+            
+            /**
+             * Represents a distinct value and its amount.
+             */
+            struct Entry {
+                T value;
+                int amount;
+            };
+            
+            /**
+             * Represents a bucket, which holds its values in the tree if it exists; else in the sorted array.
+             */
+            struct Bucket {
+                vector<Entry> sorted;
+                unique_ptr<PackedAVLTree<T>> tree;
+            };
+            
+            Unsigned minimum;
+            int shift;
+            vector<Bucket> buckets;
+            vector<int> counts;
+            int values;
+            int total;
+            
+            /**
+             * Returns the specified value as an unsigned integer with the same order, by flipping the sign bit.
+             * 
+             * @param value the value
+             * @return the unsigned integer
+             */
+            static Unsigned order(T value);
+            
+            /**
+             * Returns the bucket of the specified value, which is given by the highest bits of the distance
+             * between the value and the minimum of the expected range, so that the order of the buckets 
+             * matches the order of the values.
+             * 
+             * @param value the value
+             * @return the index of the bucket
+             */
+            int bucket(T value) const;
+            
+            /**
+             * Adds the specified difference to the number of distinct values in the specified bucket.
+             * 
+             * @param bucket the index of the bucket
+             * @param difference the difference
+             */
+            void count(int bucket, int difference);
+            
+            /**
+             * Returns the first entry in the sorted array of the specified bucket which is not smaller than 
+             * the specified value.
+             * 
+             * @param bucket the bucket
+             * @param value the value
+             * @return the entry, or the end of the sorted array
+             */
+            static typename vector<Entry>::const_iterator search(const Bucket& bucket, T value);
+        
+        public:
+            /**
+             * Constructs an empty RadixTree whose buckets evenly divide the specified range of values.
+             * 
+             * @param minimum the smallest expected value, or the smallest value of T if unspecified
+             * @param maximum the largest expected value, or the largest value of T if unspecified
+             * @throws invalid_argument if the minimum is larger than the maximum
+             */
+            RadixTree(T minimum = numeric_limits<T>::min(), T maximum = numeric_limits<T>::max());
+            
+            RadixTree(const RadixTree<T, BITS>& other);
+            
+            /**
+             * Constructs a RadixTree which takes over the buckets of the specified tree, leaving it empty.
+             * 
+             * @param other the tree to move
+             */
+            RadixTree(RadixTree<T, BITS>&& other);
+            
+            RadixTree<T, BITS>& operator=(const RadixTree<T, BITS>& other);
+            
+            /**
+             * Replaces the values in this tree with the buckets of the specified tree, leaving it empty.
+             * 
+             * @param other the tree to move
+             * @return this
+             */
+            RadixTree<T, BITS>& operator=(RadixTree<T, BITS>&& other);
+            
+            /**
+             * Removes all values.
+             */
+            void clear();
+            
+            /**
+             * Returns the number of levels of the tallest bucket plus 1 for the bucket array. The number of 
+             * levels of a sorted array is the number of steps of a binary search.
+             * 
+             * @return the height, or 0 if empty
+             */
+            int height() const;
+            
+            /**
+             * Returns the memory used by the buckets and the bucket array.
+             * 
+             * @return the memory used
+             */
+            Memory memory_usage() const;
+            
+            /**
+             * Adds the specified value. A bucket is promoted to a tree only after the tree holds all of its
+             * values, so that the tree is left unchanged if the value cannot be added.
+             * 
+             * @param value the value to add
+             * @throws invalid_argument if the value has already been added 2^30 - 1 times
+             * @return this
+             */
+            RadixTree<T, BITS>& add(T value);
+            
+            /**
+             * Removes the specified value.
+             * 
+             * @param value the value to remove
+             * @return true if the value was successfully removed; else false
+             */
+            bool remove(T value);
+            
+            /**
+             * Returns whether the specified value was added.
+             * 
+             * @param value the value
+             * @return true if the value was added; else false
+             */
+            bool contains(T value) const;
+            
+            /**
+             * Returns the number of times the specified value occurs.
+             * 
+             * @param value the value
+             * @return the amount of the value, or 0 if absent
+             */
+            int amount(T value) const;
+            
+            /**
+             * Returns the value at the specified index in ascending order, excluding duplicate values.
+             * 
+             * @implSpec
+             * Descends the Fenwick tree to find the bucket which contains the index before indexing its sorted
+             * array, or delegating to PackedAVLTree#select(int index) of its tree.
+             * 
+             * @param index the index of the value
+             * @throws invalid_argument if the specified index is less than 0 or not less than the number of nodes
+             * @return the value at the specified index
+             */
+            T operator[](int index) const;
+            
+            /**
+             * Calls the specified function with each value and its amount in ascending order.
+             * 
+             * @param function the function to call with each value and amount
+             */
+            template <class Function>
+            void for_each(Function function) const;
+            
+            /**
+             * Displays the values of the specified tree in ascending order using the specified ostream.
+             * 
+             * @param stream the ostream used to display the tree
+             * @param tree the tree to display
+             * @return the ostream
+             */
+            template <class V, int B>
+            friend ostream& operator<<(ostream& stream, const RadixTree<V, B>& tree);
+            
+            /**
+             * Returns the number of distinct values.
+             * 
+             * @return the number of distinct values
+             */
+            int nodes() const;
+            
+            /**
+             * Returns the number of values, including duplicate values.
+             * 
+             * @return the number of values
+             */
+            int size() const;
+    };
+
+    template <class T, int BITS>
+    RadixTree<T, BITS>::RadixTree(T minimum, T maximum) {
+        if (maximum < minimum) {
+            throw invalid_argument("Minimum is larger than maximum");
+        }
+        
+        this->minimum = order(minimum);
+        auto range = order(maximum) - this->minimum;
+        for (shift = 0; (range >> shift) >= (Unsigned) BUCKETS; shift++) {}
+        clear();
+    }
+
+    template <class T, int BITS>
+    RadixTree<T, BITS>::RadixTree(const RadixTree<T, BITS>& other) {
+        *this = other;
+    }
+
+    template <class T, int BITS>
+    RadixTree<T, BITS>::RadixTree(RadixTree<T, BITS>&& other) {
+        *this = std::move(other);
+    }
+
+    template <class T, int BITS>
+    RadixTree<T, BITS>& RadixTree<T, BITS>::operator=(const RadixTree<T, BITS>& other) {
+        if (this != &other) {
+            buckets = vector<Bucket>(BUCKETS);
+            for (int i = 0; i < BUCKETS; i++) {
+                buckets[i].sorted = other.buckets[i].sorted;
+                if (other.buckets[i].tree) {
+                    buckets[i].tree = unique_ptr<PackedAVLTree<T>>(new PackedAVLTree<T>(*other.buckets[i].tree));
+                }
+            }
+            minimum = other.minimum;
+            shift = other.shift;
+            counts = other.counts;
+            values = other.values;
+            total = other.total;
+        }
+        return *this;
+    }
+
+    template <class T, int BITS>
+    RadixTree<T, BITS>& RadixTree<T, BITS>::operator=(RadixTree<T, BITS>&& other) {
+        if (this != &other) {
+            buckets = std::move(other.buckets);
+            counts = std::move(other.counts);
+            minimum = other.minimum;
+            shift = other.shift;
+            values = other.values;
+            total = other.total;
+            other.clear();
+        }
+        return *this;
+    }
+
+    template <class T, int BITS>
+    void RadixTree<T, BITS>::clear() {
+        buckets = vector<Bucket>(BUCKETS);
+        counts = vector<int>(BUCKETS + 1, 0);
+        values = 0;
+        total = 0;
+    }
+
+    template <class T, int BITS>
+    typename RadixTree<T, BITS>::Unsigned RadixTree<T, BITS>::order(T value) {
+        auto bits = (Unsigned) value;
+        if (is_signed<T>::value) {
+            bits ^= (Unsigned) 1 << (sizeof(T) * CHAR_BIT - 1);
+        }
+        return bits;
+    }
+
+    template <class T, int BITS>
+    int RadixTree<T, BITS>::bucket(T value) const {
+        auto bits = order(value);
+        if (bits < minimum) {
+            return 0;
+        }
+        
+        auto index = (bits - minimum) >> shift;
+        return index < (Unsigned) BUCKETS ? (int) index : BUCKETS - 1;
+    }
+
+    template <class T, int BITS>
+    void RadixTree<T, BITS>::count(int bucket, int difference) {
+        for (int i = bucket + 1; i <= BUCKETS; i += i & -i) {
+            counts[i] += difference;
+        }
+    }
+
+    template <class T, int BITS>
+    typename vector<typename RadixTree<T, BITS>::Entry>::const_iterator RadixTree<T, BITS>::search(const Bucket& bucket, T value) {
+        return lower_bound(bucket.sorted.begin(), bucket.sorted.end(), value, [](const Entry& entry, T value) {
+            return entry.value < value;
+        });
+    }
+
+    template <class T, int BITS>
+    int RadixTree<T, BITS>::height() const {
+        int height = 0;
+        for (auto& bucket : buckets) {
+            int levels = 0;
+            if (bucket.tree) {
+                levels = bucket.tree->height();
+            
+            } else {
+                for (auto size = bucket.sorted.size(); size > 0; size /= 2) {
+                    levels++;
+                }
+            }
+            
+            if (levels > 0 && levels + 1 > height) {
+                height = levels + 1;
+            }
+        }
+        return height;
+    }
+
+    template <class T, int BITS>
+    Memory RadixTree<T, BITS>::memory_usage() const {
+        Memory memory;
+        memory.nodes = 0;
+        memory.overhead = 0;
+        memory.scratch = 0;
+        memory.indexes = buckets.capacity() * sizeof(Bucket) + counts.capacity() * sizeof(int);
+        
+        for (auto& bucket : buckets) {
+            memory.nodes += bucket.sorted.size() * sizeof(Entry);
+            memory.overhead += (bucket.sorted.capacity() - bucket.sorted.size()) * sizeof(Entry);
+            if (bucket.tree) {
+                auto usage = bucket.tree->memory_usage();
+                memory.nodes += usage.nodes;
+                memory.overhead += usage.overhead + sizeof(PackedAVLTree<T>);
+                memory.scratch = usage.scratch > memory.scratch ? usage.scratch : memory.scratch;
+            }
+        }
+        return memory;
+    }
+
+    template <class T, int BITS>
+    RadixTree<T, BITS>& RadixTree<T, BITS>::add(T value) {
+        auto index = bucket(value);
+        auto& bucket = buckets[index];
+        
+        if (bucket.tree) {
+            auto nodes = bucket.tree->nodes();
+            bucket.tree->add(value);
+            total++;
+            if (bucket.tree->nodes() == nodes) {
+                return *this;
+            }
+        
+        } else {
+            auto position = search(bucket, value);
+            if (position != bucket.sorted.end() && position->value == value) {
+                auto& entry = bucket.sorted[position - bucket.sorted.begin()];
+                if (entry.amount >= (1 << 30) - 1) {
+                    throw invalid_argument("Amount exceeds the maximum of a packed node");
+                }
+                entry.amount++;
+                total++;
+                return *this;
+            }
+            
+            if (bucket.sorted.size() >= SORTED) {
+                unique_ptr<PackedAVLTree<T>> tree(new PackedAVLTree<T>());
+                for (auto& entry : bucket.sorted) {
+                    tree->add(entry.value, entry.amount);
+                }
+                tree->add(value);
+                bucket.tree = std::move(tree);
+                vector<Entry>().swap(bucket.sorted);
+            
+            } else {
+                bucket.sorted.insert(position, Entry {value, 1});
+            }
+            total++;
+        }
+        
+        values++;
+        count(index, 1);
+        return *this;
+    }
+
+    template <class T, int BITS>
+    bool RadixTree<T, BITS>::remove(T value) {
+        auto index = bucket(value);
+        auto& bucket = buckets[index];
+        
+        if (bucket.tree) {
+            auto nodes = bucket.tree->nodes();
+            if (!bucket.tree->remove(value)) {
+                return false;
+            }
+            
+            total--;
+            if (bucket.tree->nodes() == nodes) {
+                return true;
+            }
+        
+        } else {
+            auto position = search(bucket, value);
+            if (position == bucket.sorted.end() || position->value != value) {
+                return false;
+            }
+            
+            total--;
+            if (position->amount > 1) {
+                bucket.sorted[position - bucket.sorted.begin()].amount--;
+                return true;
+            }
+            bucket.sorted.erase(position);
+        }
+        
+        values--;
+        count(index, -1);
+        return true;
+    }
+
+    template <class T, int BITS>
+    bool RadixTree<T, BITS>::contains(T value) const {
+        return amount(value) > 0;
+    }
+
+    template <class T, int BITS>
+    int RadixTree<T, BITS>::amount(T value) const {
+        auto& bucket = buckets[this->bucket(value)];
+        if (bucket.tree) {
+            return bucket.tree->amount(value);
+        }
+        
+        auto position = search(bucket, value);
+        return position != bucket.sorted.end() && position->value == value ? position->amount : 0;
+    }
+
+    template <class T, int BITS>
+    T RadixTree<T, BITS>::operator[](int index) const {
+        if (index < 0 || index >= values) {
+            throw invalid_argument("index is invalid");
+        }
+        
+        int position = 0;
+        for (int step = BUCKETS; step > 0; step /= 2) {
+            if (position + step <= BUCKETS && counts[position + step] <= index) {
+                position += step;
+                index -= counts[position];
+            }
+        }
+        auto& bucket = buckets[position];
+        return bucket.tree ? bucket.tree->select(index) : bucket.sorted[index].value;
+    }
+
+    template <class T, int BITS>
+    template <class Function>
+    void RadixTree<T, BITS>::for_each(Function function) const {
+        for (auto& bucket : buckets) {
+            if (bucket.tree) {
+                bucket.tree->for_each(function);
+            
+            } else {
+                for (auto& entry : bucket.sorted) {
+                    function(entry.value, entry.amount);
+                }
+            }
+        }
+    }
+
+    template <class T, int BITS>
+    ostream& operator<<(ostream& stream, const RadixTree<T, BITS>& tree) {
+        tree.for_each([&stream](const T& value, int amount) {
+            for (int i = 0; i < amount; i++) {
+                stream << value << endl;
+            }
+        });
+        return stream;
+    }
+
+    template <class T, int BITS>
+    int RadixTree<T, BITS>::nodes() const {
+        return values;
+    }
+
+    template <class T, int BITS>
+    int RadixTree<T, BITS>::size() const {
+        return total;
+    }
+
+}
+
+#endif /* RADIX_H */
@@ -0,0 +1,505 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2018 PohSeng#1.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   Server.h
+ * Author: Matthias Ngeo - S10172190F
+ * Author: Francis Koh - S10172072G
+ *
+ * Created on February 1, 2018, 9:40 PM
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#ifdef __linux__
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Node.h"
+
+using namespace std;
+
+namespace assignment {
+
+    /*
+     * The server accepts any number of connections on a Unix-domain socket. Each connection carries a 
+     * stream of fixed-size requests, and receives a response for each request in the order in which the
+     * requests were sent. Clients may send any number of requests without waiting for their responses.
+     * All integers are 32-bit and in the byte order of the host, since clients run on the same machine.
+     *
+     * A request consists of:
+     *
+     * operation (1 byte)   the operation, as defined by Operation
+     * first (4 bytes)      the value, the index, or the lower bound of the range
+     * second (4 bytes)     the upper bound of the range, which is ignored by the other operations
+     *
+     * A response consists of:
+     *
+     * status (1 byte)      the status, as defined by Status
+     * result (4 bytes)     the amount of the value after the operation, the value at the index, or the number
+     *                      of distinct values in the range
+     *
+     * A response to RANGE is followed by the value and amount of each distinct value in the range,
+     * in ascending order, each 4 bytes.
+     */
+
+
+    /**
+     * Represents the operation of a request.
+     */
+    enum class Operation : uint8_t {
+        ADD = 1, REMOVE = 2, CONTAINS = 3, INDEX = 4, RANGE = 5
+    };
+
+    /**
+     * Represents the status of a response.
+     */
+    enum class Status : uint8_t {
+        OK = 0, ABSENT = 1, ERROR = 2
+    };
+
+
+    /**
+     * Represents a server which exposes the specified tree of integers over a Unix-domain socket.
+     *
+     * The server runs a single-threaded event loop using epoll. Requests are read in bulk, and all responses
+     * to the requests which were read are written at once. A connection is not read from while it has more 
+     * than #LIMIT bytes of responses which are yet to be written, so that clients which do not read their 
+     * responses cannot exhaust the memory of the server.
+     */
+    template <class Tree>
+    class Server {
+        private:
+            static const int REQUEST = 9;
+            static const int RESPONSE = 5;
+            static const size_t LIMIT = 1 << 20;
+            
+            /**
+             * Represents a connection and the bytes which are yet to be processed or written.
+             */
+            struct Connection {
+                int socket;
+                vector<char> input;
+                vector<char> output;
+                size_t written;
+                uint32_t events;
+            };
+            
+            Tree& tree;
+            string path;
+            int listener;
+            int poll;
+            atomic<bool> running;
+            unordered_map<int, Connection> connections;
+            
+            /**
+             * Accepts all pending connections.
+             */
+            void accept();
+            
+            /**
+             * Reads all available requests from the specified connection before delegating to 
+             * #service(Connection& connection).
+             * 
+             * @param connection the connection
+             * @return false if the connection was closed; else true
+             */
+            bool receive(Connection& connection);
+            
+            /**
+             * Processes the complete requests of the specified connection while the responses which are yet
+             * to be written do not exceed #LIMIT, and writes as many responses as possible in a single call.
+             * Repeats until no complete request remains or the socket cannot accept more responses, since a
+             * connection whose responses were all written is not polled again until the client sends more
+             * bytes. Afterwards updates the events for which the connection is polled.
+             * 
+             * @param connection the connection
+             * @return false if the connection was closed; else true
+             */
+            bool service(Connection& connection);
+            
+            /**
+             * Processes the specified request, appending its response to the specified output.
+             * 
+             * @param request the request
+             * @param output the output
+             */
+            void process(const char* request, vector<char>& output);
+            
+            /**
+             * Closes the specified connection.
+             * 
+             * @param connection the connection
+             */
+            void close(Connection& connection);
+            
+            /**
+             * Returns the node which contains the next larger value than the specified node.
+             * 
+             * @param node the node
+             * @return the next node, or null if the specified node contains the largest value
+             */
+            static Node<int>* next(Node<int>* node);
+            
+            /**
+             * Appends the specified integer to the specified output.
+             * 
+             * @param output the output
+             * @param value the integer
+             */
+            static void put(vector<char>& output, int32_t value);
+        
+        public:
+            /**
+             * Constructs a Server which listens on the Unix-domain socket at the specified path, replacing
+             * any existing socket at the path.
+             * 
+             * @param tree the tree
+             * @param path the path of the socket
+             * @throws invalid_argument if the path is too long
+             * @throws system_error if the socket could not be created
+             */
+            Server(Tree& tree, const string& path);
+            
+            Server(const Server&) = delete;
+            
+            Server& operator=(const Server&) = delete;
+            
+            /**
+             * Closes all connections and removes the socket.
+             */
+            ~Server();
+            
+            /**
+             * Runs the event loop until #stop() is called.
+             * 
+             * @throws system_error if polling fails
+             */
+            void run();
+            
+            /**
+             * Stops the event loop within 100 milliseconds. This method may be called from any thread.
+             */
+            void stop();
+    };
+
+    template <class Tree>
+    Server<Tree>::Server(Tree& tree, const string& path) : tree(tree), path(path), running(false) {
+        sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            throw invalid_argument("Socket path is too long");
+        }
+        strcpy(address.sun_path, path.c_str());
+        unlink(path.c_str());
+        
+        listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listener < 0) {
+            throw system_error(errno, system_category(), "Failed to create socket");
+        }
+        
+        if (bind(listener, (sockaddr*) &address, sizeof(address)) < 0 || listen(listener, SOMAXCONN) < 0) {
+            auto error = errno;
+            ::close(listener);
+            throw system_error(error, system_category(), "Failed to listen on " + path);
+        }
+        
+        poll = epoll_create1(EPOLL_CLOEXEC);
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.fd = listener;
+        if (poll < 0 || epoll_ctl(poll, EPOLL_CTL_ADD, listener, &event) < 0) {
+            auto error = errno;
+            ::close(listener);
+            unlink(path.c_str());
+            throw system_error(error, system_category(), "Failed to poll socket");
+        }
+    }
+
+    template <class Tree>
+    Server<Tree>::~Server() {
+        for (auto& entry : connections) {
+            ::close(entry.first);
+        }
+        ::close(poll);
+        ::close(listener);
+        unlink(path.c_str());
+    }
+
+    template <class Tree>
+    void Server<Tree>::run() {
+        epoll_event events[64];
+        running = true;
+        
+        while (running) {
+            auto count = epoll_wait(poll, events, 64, 100);
+            if (count < 0 && errno != EINTR) {
+                throw system_error(errno, system_category(), "Failed to wait for events");
+            }
+            
+            for (int i = 0; i < count; i++) {
+                if (events[i].data.fd == listener) {
+                    accept();
+                    continue;
+                }
+                
+                auto entry = connections.find(events[i].data.fd);
+                if (entry == connections.end()) {
+                    continue;
+                }
+                
+                auto& connection = entry->second;
+                if (events[i].events & (EPOLLERR | EPOLLHUP) && !(events[i].events & EPOLLIN)) {
+                    close(connection);
+                
+                } else if (events[i].events & EPOLLIN) {
+                    receive(connection);
+                
+                } else if (events[i].events & EPOLLOUT) {
+                    service(connection);
+                }
+            }
+        }
+    }
+
+    template <class Tree>
+    void Server<Tree>::stop() {
+        running = false;
+    }
+
+    template <class Tree>
+    void Server<Tree>::accept() {
+        while (true) {
+            auto socket = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (socket < 0) {
+                return;
+            }
+            
+            epoll_event event;
+            event.events = EPOLLIN;
+            event.data.fd = socket;
+            if (epoll_ctl(poll, EPOLL_CTL_ADD, socket, &event) < 0) {
+                ::close(socket);
+                continue;
+            }
+            connections[socket] = Connection{socket, {}, {}, 0, EPOLLIN};
+        }
+    }
+
+    template <class Tree>
+    bool Server<Tree>::receive(Connection& connection) {
+        char buffer[64 * 1024];
+        while (true) {
+            auto count = recv(connection.socket, buffer, sizeof(buffer), 0);
+            if (count > 0) {
+                connection.input.insert(connection.input.end(), buffer, buffer + count);
+                if (count < (ssize_t) sizeof(buffer)) {
+                    break;
+                }
+            
+            } else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            
+            } else if (count < 0 && errno == EINTR) {
+                continue;
+            
+            } else {
+                close(connection);
+                return false;
+            }
+        }
+        
+        return service(connection);
+    }
+
+    template <class Tree>
+    bool Server<Tree>::service(Connection& connection) {
+        auto& input = connection.input;
+        auto& output = connection.output;
+        
+        size_t consumed = 0;
+        bool blocked = false;
+        while (!blocked) {
+            while (input.size() - consumed >= REQUEST && output.size() - connection.written < LIMIT) {
+                process(&input[consumed], output);
+                consumed += REQUEST;
+            }
+            
+            while (connection.written < output.size()) {
+                auto count = send(connection.socket, &output[connection.written], output.size() - connection.written, MSG_NOSIGNAL);
+                if (count > 0) {
+                    connection.written += count;
+                
+                } else if (count < 0 && errno == EINTR) {
+                    continue;
+                
+                } else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    blocked = true;
+                    break;
+                
+                } else {
+                    close(connection);
+                    return false;
+                }
+            }
+            
+            if (connection.written == output.size()) {
+                output.clear();
+                connection.written = 0;
+            }
+            
+            if (input.size() - consumed < REQUEST) {
+                break;
+            }
+        }
+        input.erase(input.begin(), input.begin() + consumed);
+        
+        auto pending = output.size() - connection.written;
+        uint32_t events = (pending < LIMIT ? (uint32_t) EPOLLIN : 0) | (pending > 0 ? (uint32_t) EPOLLOUT : 0);
+        if (events != connection.events) {
+            epoll_event event;
+            event.events = events;
+            event.data.fd = connection.socket;
+            epoll_ctl(poll, EPOLL_CTL_MOD, connection.socket, &event);
+            connection.events = events;
+        }
+        return true;
+    }
+
+    template <class Tree>
+    void Server<Tree>::process(const char* request, vector<char>& output) {
+        auto operation = (Operation) request[0];
+        int32_t first;
+        int32_t second;
+        memcpy(&first, request + 1, sizeof(first));
+        memcpy(&second, request + 5, sizeof(second));
+        
+        switch (operation) {
+            case Operation::ADD:
+                output.push_back((char) Status::OK);
+                put(output, tree.add(nullptr, first)->amount);
+                break;
+            
+            case Operation::REMOVE: {
+                auto removed = tree.remove(first);
+                output.push_back((char) (removed ? Status::OK : Status::ABSENT));
+                put(output, tree.amount(first));
+                break;
+            }
+            
+            case Operation::CONTAINS: {
+                auto amount = tree.amount(first);
+                output.push_back((char) (amount > 0 ? Status::OK : Status::ABSENT));
+                put(output, amount);
+                break;
+            }
+            
+            case Operation::INDEX:
+                if (0 <= first && first < tree.nodes()) {
+                    output.push_back((char) Status::OK);
+                    put(output, tree[first]);
+                
+                } else {
+                    output.push_back((char) Status::ERROR);
+                    put(output, 0);
+                }
+                break;
+            
+            case Operation::RANGE: {
+                vector<shared_ptr<Node<int>>> lower;
+                tree.lower_bound_batch(vector<int> {first}, lower);
+                
+                output.push_back((char) Status::OK);
+                auto count = output.size();
+                put(output, 0);
+                
+                int32_t values = 0;
+                for (auto node = lower[0].get(); node && node->value <= second; node = next(node)) {
+                    put(output, node->value);
+                    put(output, node->amount);
+                    values++;
+                }
+                memcpy(&output[count], &values, sizeof(values));
+                break;
+            }
+            
+            default:
+                output.push_back((char) Status::ERROR);
+                put(output, 0);
+                break;
+        }
+    }
+
+    template <class Tree>
+    void Server<Tree>::close(Connection& connection) {
+        auto socket = connection.socket;
+        epoll_ctl(poll, EPOLL_CTL_DEL, socket, nullptr);
+        ::close(socket);
+        connections.erase(socket);
+    }
+
+    template <class Tree>
+    Node<int>* Server<Tree>::next(Node<int>* node) {
+        if (node->right) {
+            node = node->right.get();
+            while (node->left) {
+                node = node->left.get();
+            }
+            return node;
+        }
+        
+        while (node->parent && node->parent->right.get() == node) {
+            node = node->parent.get();
+        }
+        return node->parent.get();
+    }
+
+    template <class Tree>
+    void Server<Tree>::put(vector<char>& output, int32_t value) {
+        auto size = output.size();
+        output.resize(size + sizeof(value));
+        memcpy(&output[size], &value, sizeof(value));
+    }
+
+}
+
+#endif /* __linux__ */
+
+#endif /* SERVER_H */
@@ -0,0 +1,430 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2018 PohSeng#1.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   Shared.h
+ * Author: Matthias Ngeo - S10172190F
+ * Author: Francis Koh - S10172072G
+ *
+ * Created on February 7, 2018, 10:20 AM
+ */
+
+#ifndef SHARED_H
+#define SHARED_H
+
+#ifdef __linux__
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Static.h"
+
+using namespace std;
+
+namespace assignment {
+
+    /**
+     * Represents the access of a process to a SharedAVLTree.
+     */
+    enum class Access {
+        WRITE, READ
+    };
+
+
+    /**
+     * Represents an AVL tree whose nodes live in a POSIX shared memory segment, so that the processes on a
+     * host share a single copy of the tree instead of holding a copy each. The segment holds a
+     * StaticAVLTree<T, N>, whose nodes refer to their children by indexes instead of pointers, and hence
+     * remain valid regardless of the address at which each process maps the segment.
+     *
+     * A single process creates and writes the tree, while any number of processes read it. Writes are
+     * guarded by a sequence lock: the sequence is odd while the tree is being modified, and a read is
+     * retried if the sequence was odd or changed while reading. Hence readers never take a lock or block
+     * the writer, and always observe the tree as it was between two writes.
+     *
+     * The values must be trivially copyable, since they are shared between processes as raw memory.
+     */
+    template <class T, int N>
+    class SharedAVLTree {
+        static_assert(is_trivially_copyable<T>::value, "SharedAVLTree requires trivially copyable values");
+        static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "SharedAVLTree requires lock-free 64-bit atomics");
+        
+        private:
+            /**
+             * Represents the contents of the shared memory segment.
+             */
+            struct Segment {
+                atomic<uint64_t> sequence;
+                StaticAVLTree<T, N> tree;
+                
+                Segment() : sequence(0), tree() {}
+            };
+            
+            string name;
+            Access access;
+            Segment* segment;
+            
+            /**
+             * Calls the specified function until the sequence was even and unchanged during the call.
+             *
+             * @implSpec
+             * The function may observe the tree while it is being modified, and must therefore neither
+             * fail nor loop indefinitely if the tree is inconsistent. Its results are discarded unless the
+             * sequence is unchanged afterwards.
+             *
+             * @param function the function which reads the tree
+             * @return the result of the function from a consistent read
+             */
+            template <class Function>
+            auto read(Function function) const -> decltype(function());
+            
+            /**
+             * Calls the specified function while the sequence is odd.
+             *
+             * @param function the function which modifies the tree
+             * @return the result of the function
+             * @throws logic_error if the tree was opened for reading
+             */
+            template <class Function>
+            auto write(Function function) -> decltype(function());
+            
+            /**
+             * Returns the node which contains the specified value, without following more links than the
+             * height of the tree can be, or following an index outside of the slots.
+             *
+             * @param value the value
+             * @return the node, or 0 if the tree does not contain the value or is inconsistent
+             */
+            int find(const T& value) const;
+        
+        public:
+            /**
+             * Constructs a SharedAVLTree in the shared memory segment with the specified name.
+             *
+             * If opened for writing, the segment is created and holds an empty tree. The name is removed
+             * when the SharedAVLTree is destroyed, although processes which opened it keep their mapping.
+             * If opened for reading, the segment must have been created by a writer with the same type.
+             *
+             * @param name the name of the segment, which starts with a slash
+             * @param access WRITE to create the tree, or READ to open an existing tree
+             * @throws system_error if the segment could not be created, opened or mapped
+             * @throws invalid_argument if the existing segment does not hold a tree of the same type
+             */
+            SharedAVLTree(const string& name, Access access);
+            
+            SharedAVLTree(const SharedAVLTree& other) = delete;
+            
+            SharedAVLTree& operator=(const SharedAVLTree& other) = delete;
+            
+            /**
+             * Unmaps the segment, and removes its name if the tree was opened for writing.
+             */
+            ~SharedAVLTree();
+            
+            /**
+             * Adds the specified value if the tree contains the value or has room for another node.
+             *
+             * @param value the value to add
+             * @return true if the value was added; false if the tree is full
+             * @throws logic_error if the tree was opened for reading
+             */
+            bool add(const T& value);
+            
+            /**
+             * Removes the specified value.
+             *
+             * @param value the value to remove
+             * @return true if the value was successfully removed; else false
+             * @throws logic_error if the tree was opened for reading
+             */
+            bool remove(const T& value);
+            
+            /**
+             * Removes all values from the tree.
+             *
+             * @throws logic_error if the tree was opened for reading
+             */
+            void clear();
+            
+            /**
+             * Returns whether the tree contains the specified value.
+             *
+             * @param value the value
+             * @return true if the tree contains the specified value; else false
+             */
+            bool contains(const T& value) const;
+            
+            /**
+             * Returns the number of times the specified value occurs in the tree.
+             *
+             * @param value the value
+             * @return the amount of the value, or 0 if the tree does not contain it
+             */
+            int amount(const T& value) const;
+            
+            /**
+             * Returns the distinct values between the specified bounds and their amounts, in ascending order.
+             *
+             * @implSpec
+             * Iterates through the nodes in ascending order using a stack of at most the largest height
+             * of the tree, skipping the left subtrees of nodes smaller than the lower bound and stopping at
+             * the first node larger than the upper bound. The iteration is abandoned if it visits more
+             * nodes than the tree holds, or follows an index outside of the slots, which only happens if
+             * the tree was modified and hence the range is read again.
+             *
+             * @param lower the smallest value in the range
+             * @param upper the largest value in the range
+             * @return the values in the range and their amounts
+             */
+            vector<pair<T, int>> range(const T& lower, const T& upper) const;
+            
+            /**
+             * Returns the memory used by the tree, which is shared by all processes which opened it.
+             *
+             * @return the memory used by the tree
+             */
+            Memory memory_usage() const;
+            
+            /**
+             * Returns the number of nodes in the tree.
+             *
+             * @return the number of nodes in the tree, excluding duplicate values
+             */
+            int nodes() const;
+            
+            /**
+             * Returns the number of values in the tree.
+             *
+             * @return the number of values in the tree, including duplicate values
+             */
+            int size() const;
+    };
+
+    template <class T, int N>
+    SharedAVLTree<T, N>::SharedAVLTree(const string& name, Access access) : name(name), access(access), segment(nullptr) {
+        bool writing = access == Access::WRITE;
+        int file = writing ? shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644) : shm_open(name.c_str(), O_RDONLY, 0);
+        if (file < 0) {
+            throw system_error(errno, system_category(), "Failed to open shared memory " + name);
+        }
+        
+        struct stat status;
+        if (writing && ftruncate(file, sizeof(Segment)) < 0) {
+            auto error = errno;
+            close(file);
+            shm_unlink(name.c_str());
+            throw system_error(error, system_category(), "Failed to size shared memory " + name);
+        
+        } else if (!writing && (fstat(file, &status) < 0 || (size_t) status.st_size != sizeof(Segment))) {
+            close(file);
+            throw invalid_argument("Shared memory " + name + " does not hold a tree of this type");
+        }
+        
+        auto mapping = mmap(nullptr, sizeof(Segment), writing ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, file, 0);
+        auto error = errno;
+        close(file);
+        if (mapping == MAP_FAILED) {
+            if (writing) {
+                shm_unlink(name.c_str());
+            }
+            throw system_error(error, system_category(), "Failed to map shared memory " + name);
+        }
+        
+        segment = writing ? new (mapping) Segment() : static_cast<Segment*>(mapping);
+    }
+
+    template <class T, int N>
+    SharedAVLTree<T, N>::~SharedAVLTree() {
+        munmap(segment, sizeof(Segment));
+        if (access == Access::WRITE) {
+            shm_unlink(name.c_str());
+        }
+    }
+
+    template <class T, int N>
+    template <class Function>
+    auto SharedAVLTree<T, N>::read(Function function) const -> decltype(function()) {
+        while (true) {
+            auto sequence = segment->sequence.load(memory_order_acquire);
+            if (sequence & 1) {
+                this_thread::yield();
+                continue;
+            }
+            
+            auto result = function();
+            atomic_thread_fence(memory_order_acquire);
+            if (segment->sequence.load(memory_order_relaxed) == sequence) {
+                return result;
+            }
+        }
+    }
+
+    template <class T, int N>
+    template <class Function>
+    auto SharedAVLTree<T, N>::write(Function function) -> decltype(function()) {
+        if (access != Access::WRITE) {
+            throw logic_error("Shared memory " + name + " was opened for reading");
+        }
+        
+        auto sequence = segment->sequence.load(memory_order_relaxed);
+        segment->sequence.store(sequence + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        
+        auto result = function();
+        segment->sequence.store(sequence + 2, memory_order_release);
+        return result;
+    }
+
+    template <class T, int N>
+    int SharedAVLTree<T, N>::find(const T& value) const {
+        auto& tree = segment->tree;
+        auto node = tree.root;
+        for (int depth = 0; 0 < node && node <= N && depth < StaticAVLTree<T, N>::DEPTH; depth++) {
+            auto& slot = tree.slots[node];
+            if (value < slot.value) {
+                node = slot.children[0];
+            
+            } else if (slot.value < value) {
+                node = slot.children[1];
+            
+            } else {
+                return node;
+            }
+        }
+        return 0;
+    }
+
+    template <class T, int N>
+    bool SharedAVLTree<T, N>::add(const T& value) {
+        return write([&]() {
+            return segment->tree.add(value);
+        });
+    }
+
+    template <class T, int N>
+    bool SharedAVLTree<T, N>::remove(const T& value) {
+        return write([&]() {
+            return segment->tree.remove(value);
+        });
+    }
+
+    template <class T, int N>
+    void SharedAVLTree<T, N>::clear() {
+        write([&]() {
+            segment->tree.clear();
+            return true;
+        });
+    }
+
+    template <class T, int N>
+    bool SharedAVLTree<T, N>::contains(const T& value) const {
+        return amount(value) > 0;
+    }
+
+    template <class T, int N>
+    int SharedAVLTree<T, N>::amount(const T& value) const {
+        return read([&]() {
+            auto node = find(value);
+            return node ? segment->tree.slots[node].amount : 0;
+        });
+    }
+
+    template <class T, int N>
+    vector<pair<T, int>> SharedAVLTree<T, N>::range(const T& lower, const T& upper) const {
+        return read([&]() {
+            auto& tree = segment->tree;
+            vector<pair<T, int>> values;
+            int stack[StaticAVLTree<T, N>::DEPTH];
+            int depth = 0;
+            
+            auto node = tree.root;
+            for (int steps = 0; (node || depth > 0) && steps <= 2 * N; steps++) {
+                if (node) {
+                    if (node < 0 || node > N || depth == StaticAVLTree<T, N>::DEPTH) {
+                        break;
+                    }
+                    
+                    auto& slot = tree.slots[node];
+                    if (slot.value < lower) {
+                        node = slot.children[1];
+                    
+                    } else {
+                        stack[depth++] = node;
+                        node = slot.children[0];
+                    }
+                
+                } else {
+                    auto& slot = tree.slots[stack[--depth]];
+                    if (upper < slot.value) {
+                        break;
+                    }
+                    
+                    values.emplace_back(slot.value, slot.amount);
+                    node = slot.children[1];
+                }
+            }
+            return values;
+        });
+    }
+
+    template <class T, int N>
+    Memory SharedAVLTree<T, N>::memory_usage() const {
+        return read([&]() {
+            return segment->tree.memory_usage();
+        });
+    }
+
+    template <class T, int N>
+    int SharedAVLTree<T, N>::nodes() const {
+        return read([&]() {
+            return segment->tree.nodes();
+        });
+    }
+
+    template <class T, int N>
+    int SharedAVLTree<T, N>::size() const {
+        return read([&]() {
+            return segment->tree.size();
+        });
+    }
+
+}
+
+#endif
+
+#endif /* SHARED_H */
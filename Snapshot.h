@@ -0,0 +1,699 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2018 PohSeng#1.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   Snapshot.h
+ * Author: Matthias Ngeo - S10172190F
+ * Author: Francis Koh - S10172072G
+ *
+ * Created on February 9, 2018, 10:20 AM
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "Iterator.h"
+#include "Tree.h"
+
+using namespace std;
+
+namespace assignment {
+
+    /**
+     * Represents an immutable, compressed snapshot of the values in an AVLTree<int>, which supports
+     * membership, rank and select queries and ascending iteration without decompressing the values.
+     *
+     * The distinct values are stored using Elias-Fano encoding. Each value is offset by the smallest
+     * value and split into its lower bits, which are packed into an array, and its upper bits, which are
+     * stored in unary as the gaps between the set bits of a bit vector. With n distinct values spanning a
+     * range of u, each value takes 2 + log2(u / n) bits. The amounts of the values are stored in order as
+     * variable-length integers, of which amounts below 128 take a single byte.
+     *
+     * Every 256th set bit and every 256th unset bit of the bit vector, together with the position and
+     * running total of the amount of every 64th value, are sampled so that queries only decode a bounded
+     * number of bits and amounts. The samples are not stored by #write(ostream& stream) but rebuilt when a
+     * snapshot is read.
+     */
+    class Snapshot {
+        private:
+            static const int SAMPLE = 256;
+            static const int BLOCK = 64;
+            
+            int count;
+            int minimum;
+            int maximum;
+            int width;
+            long long total;
+            
+            vector<uint64_t> lows;
+            vector<uint64_t> highs;
+            vector<uint8_t> amounts;
+            
+            vector<uint64_t> ones;
+            vector<uint64_t> zeros;
+            vector<uint64_t> offsets;
+            vector<long long> prefixes;
+            
+            /**
+             * Allocates the arrays for the specified number of distinct values between the specified
+             * smallest and largest value, and chooses the number of lower bits of each value.
+             *
+             * @param count the number of distinct values
+             * @param minimum the smallest value
+             * @param maximum the largest value
+             */
+            void reserve(int count, int minimum, int maximum);
+            
+            /**
+             * Appends the specified value with the specified amount, which must be larger than the
+             * previously appended value.
+             *
+             * @param index the number of values previously appended
+             * @param value the value
+             * @param amount the amount of the value
+             */
+            void append(int index, int value, int amount);
+            
+            /**
+             * Builds the samples of the bit vector and the amounts, and computes the total amount.
+             *
+             * @throws invalid_argument if the encoded amounts are malformed
+             */
+            void sample();
+            
+            /**
+             * Returns the lower bits of the value at the specified index.
+             *
+             * @param index the index of the value, between 0 and nodes() - 1
+             * @return the lower bits of the value
+             */
+            uint64_t low(int index) const;
+            
+            /**
+             * Returns the position of the next set bit in the bit vector at or after the specified position.
+             *
+             * @param position the position
+             * @return the position of the next set bit
+             */
+            uint64_t next(uint64_t position) const;
+            
+            /**
+             * Returns the position of the set bit of the bit vector with the specified rank.
+             *
+             * @implSpec
+             * Starts from the nearest sampled set bit and skips whole words of the bit vector by their
+             * population counts, before clearing the lowest set bits of the final word.
+             *
+             * @param rank the number of set bits before the set bit, between 0 and nodes() - 1
+             * @return the position of the set bit
+             */
+            uint64_t select1(uint64_t rank) const;
+            
+            /**
+             * Returns the position of the unset bit of the bit vector with the specified rank.
+             *
+             * @param rank the number of unset bits before the unset bit
+             * @return the position of the unset bit
+             */
+            uint64_t select0(uint64_t rank) const;
+            
+            /**
+             * Returns the distinct value at the specified index.
+             *
+             * @param index the index of the value, between 0 and nodes() - 1
+             * @return the value
+             */
+            int key(int index) const;
+            
+            /**
+             * Returns the index of the first distinct value which is not less than the specified value.
+             *
+             * @implSpec
+             * Locates the bucket of values which share the upper bits of the specified value using
+             * #select0(uint64_t rank), and compares the lower bits of the values in the bucket. Hence, this
+             * method takes O(1) time on average.
+             *
+             * @param value the value
+             * @return the index of the first value which is not less than the value, or nodes() if there is none
+             */
+            int lower(int value) const;
+            
+            /**
+             * Decodes the amount at the specified position of the encoded amounts and advances the position.
+             *
+             * @param position the position of the amount
+             * @return the amount, or -1 if the amount is malformed
+             */
+            int decode(uint64_t& position) const;
+        
+        public:
+            /**
+             * Represents an iterator over the values in a Snapshot in ascending order, which follows the
+             * protocol of Iterator<T> but is returned by value.
+             */
+            class Iterator {
+                private:
+                    const Snapshot* snapshot;
+                    int index;
+                    uint64_t position;
+                    uint64_t offset;
+                    int value;
+                    int count;
+                
+                public:
+                    /**
+                     * Constructs an Iterator over the specified snapshot.
+                     *
+                     * @param snapshot the snapshot
+                     */
+                    Iterator(const Snapshot* snapshot);
+                    
+                    /**
+                     * Iterates to the next value in the iteration.
+                     *
+                     * @implSpec
+                     * Scans the bit vector for the next set bit, and decodes the next amount. Hence, iterating
+                     * through all values takes O(n) time.
+                     *
+                     * @return true if the iteration has more values; else false
+                     */
+                    bool operator++();
+                    
+                    /**
+                     * Iterates to the next value in the iteration.
+                     *
+                     * @return true if the iteration has more values; else false
+                     */
+                    bool operator++(int);
+                    
+                    /**
+                     * Returns the current value in the iteration.
+                     *
+                     * @return the current value
+                     */
+                    int get() const;
+                    
+                    /**
+                     * Returns the amount of the current value in the iteration.
+                     *
+                     * @return the amount of the current value
+                     */
+                    int amount() const;
+            };
+            
+            /**
+             * Constructs a Snapshot of the values in the specified tree. Tombstones are excluded.
+             *
+             * @implSpec
+             * Iterates through the tree in ascending order twice, first to find the smallest and largest
+             * values, and then to encode the values. Hence, this constructor takes O(n) time and only
+             * allocates the compressed arrays.
+             *
+             * @param tree the tree
+             */
+            template <class Balance, class Augment>
+            Snapshot(AVLTree<int, Balance, Augment>& tree);
+            
+            /**
+             * Constructs a Snapshot from the snapshot written to the specified stream by
+             * #write(ostream& stream).
+             *
+             * @implSpec
+             * Rebuilds the samples and iterates through the values to verify that they are in ascending
+             * order and lie between the smallest and largest value. Hence, this constructor takes O(n) time.
+             *
+             * @param stream the stream
+             * @throws invalid_argument if the stream does not contain a well-formed snapshot
+             */
+            Snapshot(istream& stream);
+            
+            /**
+             * Writes the snapshot to the specified stream, excluding the samples.
+             *
+             * @param stream the stream
+             */
+            void write(ostream& stream) const;
+            
+            /**
+             * Returns whether the snapshot contains the specified value.
+             *
+             * @param value the value
+             * @return true if the snapshot contains the value; else false
+             */
+            bool contains(int value) const;
+            
+            /**
+             * Returns the amount of the specified value.
+             *
+             * @param value the value
+             * @return the amount of the value, or 0 if the snapshot does not contain the value
+             */
+            int amount(int value) const;
+            
+            /**
+             * Returns the number of values less than the specified value, including duplicate values.
+             *
+             * @implSpec
+             * Adds the amounts of the values in the block of the first value which is not less than the
+             * specified value to the running total sampled for the block. Hence, this method takes O(1) time.
+             *
+             * @param value the value
+             * @return the number of values less than the value
+             */
+            long long rank(int value) const;
+            
+            /**
+             * Returns the value at the specified index in ascending order, including duplicate values.
+             *
+             * @implSpec
+             * Binary searches the running totals sampled for each block of values, and adds the amounts of
+             * the values in the block until the index is reached. Hence, this method takes O(log(n)) time.
+             *
+             * @param index the index of the value, between 0 and size() - 1
+             * @throws invalid_argument if the specified index is less than 0 or greater than or equal to the number of values
+             * @return the value at the specified index
+             */
+            int select(long long index) const;
+            
+            /**
+             * Returns an iterator over the values in ascending order.
+             *
+             * @return the iterator
+             */
+            Iterator iterator() const;
+            
+            /**
+             * Returns the number of distinct values in the snapshot.
+             *
+             * @return the number of distinct values
+             */
+            int nodes() const;
+            
+            /**
+             * Returns the number of values in the snapshot, including duplicate values.
+             *
+             * @return the number of values
+             */
+            long long size() const;
+            
+            /**
+             * Returns the memory used by the snapshot. The encoded values and amounts are counted as
+             * nodes, and the samples as indexes.
+             *
+             * @return the memory used by the snapshot
+             */
+            Memory memory_usage() const;
+    };
+
+    template <class Balance, class Augment>
+    Snapshot::Snapshot(AVLTree<int, Balance, Augment>& tree) {
+        int count = 0;
+        int minimum = 0;
+        int maximum = 0;
+        
+        auto iterator = tree.iterator(Traversal::ASCENDING);
+        while ((*iterator)++) {
+            minimum = count == 0 ? iterator->get()->value : minimum;
+            maximum = iterator->get()->value;
+            count++;
+        }
+        
+        reserve(count, minimum, maximum);
+        
+        int index = 0;
+        iterator = tree.iterator(Traversal::ASCENDING);
+        while ((*iterator)++) {
+            auto node = iterator->get();
+            append(index++, node->value, node->amount);
+        }
+        
+        amounts.shrink_to_fit();
+        sample();
+    }
+
+    inline Snapshot::Snapshot(istream& stream) {
+        int header[4];
+        uint64_t length = 0;
+        stream.read(reinterpret_cast<char*>(header), sizeof(header));
+        stream.read(reinterpret_cast<char*>(&length), sizeof(length));
+        if (!stream || header[0] < 0 || (header[0] > 0 && header[1] > header[2]) || length < (uint64_t) header[0] || length > (uint64_t) header[0] * 5) {
+            throw invalid_argument("Snapshot is malformed");
+        }
+        
+        reserve(header[0], header[1], header[2]);
+        if (header[3] != width) {
+            throw invalid_argument("Snapshot is malformed");
+        }
+        
+        amounts.resize(length);
+        stream.read(reinterpret_cast<char*>(lows.data()), lows.size() * sizeof(uint64_t));
+        stream.read(reinterpret_cast<char*>(highs.data()), highs.size() * sizeof(uint64_t));
+        stream.read(reinterpret_cast<char*>(amounts.data()), amounts.size());
+        if (!stream) {
+            throw invalid_argument("Snapshot is malformed");
+        }
+        
+        sample();
+        
+        long long previous = (long long) minimum - 1;
+        for (auto iterator = this->iterator(); iterator++; previous = iterator.get()) {
+            if (iterator.get() <= previous || iterator.get() > maximum) {
+                throw invalid_argument("Snapshot is malformed");
+            }
+        }
+        
+        if (count > 0 && (previous != maximum || key(0) != minimum)) {
+            throw invalid_argument("Snapshot is malformed");
+        }
+    }
+
+    inline void Snapshot::reserve(int count, int minimum, int maximum) {
+        this->count = count;
+        this->minimum = minimum;
+        this->maximum = maximum;
+        
+        uint64_t range = count > 0 ? (uint64_t) ((int64_t) maximum - minimum) : 0;
+        width = 0;
+        while (count > 0 && (range >> (width + 1)) >= (uint64_t) count) {
+            width++;
+        }
+        
+        lows.assign(((uint64_t) count * width + 63) / 64, 0);
+        highs.assign(((uint64_t) count + (range >> width) + 1 + 63) / 64, 0);
+        amounts.clear();
+        amounts.reserve(count);
+    }
+
+    inline void Snapshot::append(int index, int value, int amount) {
+        uint64_t offset = (uint64_t) ((int64_t) value - minimum);
+        
+        if (width > 0) {
+            uint64_t bit = (uint64_t) index * width;
+            uint64_t bits = offset & ((1ULL << width) - 1);
+            lows[bit / 64] |= bits << (bit % 64);
+            if (bit % 64 + width > 64) {
+                lows[bit / 64 + 1] |= bits >> (64 - bit % 64);
+            }
+        }
+        
+        uint64_t position = (offset >> width) + index;
+        highs[position / 64] |= 1ULL << (position % 64);
+        
+        uint32_t remaining = amount;
+        while (remaining >= 0x80) {
+            amounts.push_back((uint8_t) (remaining | 0x80));
+            remaining >>= 7;
+        }
+        amounts.push_back((uint8_t) remaining);
+    }
+
+    inline void Snapshot::sample() {
+        ones.clear();
+        zeros.clear();
+        offsets.clear();
+        prefixes.clear();
+        
+        uint64_t set = 0;
+        uint64_t unset = 0;
+        uint64_t bits = highs.size() * 64;
+        for (uint64_t position = 0; position < bits; position++) {
+            if (highs[position / 64] >> (position % 64) & 1) {
+                if (set % SAMPLE == 0) {
+                    ones.push_back(position);
+                }
+                set++;
+            
+            } else {
+                if (unset % SAMPLE == 0) {
+                    zeros.push_back(position);
+                }
+                unset++;
+            }
+        }
+        
+        if (set != (uint64_t) count) {
+            throw invalid_argument("Snapshot is malformed");
+        }
+        
+        total = 0;
+        uint64_t position = 0;
+        for (int i = 0; i <= count; i++) {
+            if (i % BLOCK == 0) {
+                offsets.push_back(position);
+                prefixes.push_back(total);
+            }
+            
+            if (i < count) {
+                if (position >= amounts.size()) {
+                    throw invalid_argument("Snapshot is malformed");
+                }
+                
+                auto amount = decode(position);
+                if (amount <= 0 || position > amounts.size()) {
+                    throw invalid_argument("Snapshot is malformed");
+                }
+                total += amount;
+            }
+        }
+        
+        if (position != amounts.size()) {
+            throw invalid_argument("Snapshot is malformed");
+        }
+        
+        ones.shrink_to_fit();
+        zeros.shrink_to_fit();
+        offsets.shrink_to_fit();
+        prefixes.shrink_to_fit();
+    }
+
+    inline uint64_t Snapshot::low(int index) const {
+        if (width == 0) {
+            return 0;
+        }
+        
+        uint64_t bit = (uint64_t) index * width;
+        uint64_t bits = lows[bit / 64] >> (bit % 64);
+        if (bit % 64 + width > 64) {
+            bits |= lows[bit / 64 + 1] << (64 - bit % 64);
+        }
+        return bits & ((1ULL << width) - 1);
+    }
+
+    inline uint64_t Snapshot::next(uint64_t position) const {
+        auto word = position / 64;
+        auto bits = highs[word] & (~0ULL << (position % 64));
+        while (!bits) {
+            bits = highs[++word];
+        }
+        return word * 64 + __builtin_ctzll(bits);
+    }
+
+    inline uint64_t Snapshot::select1(uint64_t rank) const {
+        auto position = ones[rank / SAMPLE];
+        auto remaining = rank % SAMPLE;
+        
+        auto word = position / 64;
+        auto bits = highs[word] & (~0ULL << (position % 64));
+        for (uint64_t population = __builtin_popcountll(bits); population <= remaining; population = __builtin_popcountll(bits)) {
+            remaining -= population;
+            bits = highs[++word];
+        }
+        
+        for (; remaining > 0; remaining--) {
+            bits &= bits - 1;
+        }
+        return word * 64 + __builtin_ctzll(bits);
+    }
+
+    inline uint64_t Snapshot::select0(uint64_t rank) const {
+        auto position = zeros[rank / SAMPLE];
+        auto remaining = rank % SAMPLE;
+        
+        auto word = position / 64;
+        auto bits = ~highs[word] & (~0ULL << (position % 64));
+        for (uint64_t population = __builtin_popcountll(bits); population <= remaining; population = __builtin_popcountll(bits)) {
+            remaining -= population;
+            bits = ~highs[++word];
+        }
+        
+        for (; remaining > 0; remaining--) {
+            bits &= bits - 1;
+        }
+        return word * 64 + __builtin_ctzll(bits);
+    }
+
+    inline int Snapshot::key(int index) const {
+        uint64_t high = select1(index) - index;
+        return (int) ((int64_t) minimum + (int64_t) ((high << width) | low(index)));
+    }
+
+    inline int Snapshot::lower(int value) const {
+        if (count == 0 || value <= minimum) {
+            return 0;
+        
+        } else if (value > maximum) {
+            return count;
+        }
+        
+        uint64_t offset = (uint64_t) ((int64_t) value - minimum);
+        uint64_t high = offset >> width;
+        uint64_t bits = offset & ((1ULL << width) - 1);
+        
+        uint64_t position = high == 0 ? 0 : select0(high - 1) + 1;
+        int index = (int) (position - high);
+        while (highs[position / 64] >> (position % 64) & 1) {
+            if (low(index) >= bits) {
+                break;
+            }
+            position++;
+            index++;
+        }
+        return index;
+    }
+
+    inline int Snapshot::decode(uint64_t& position) const {
+        uint32_t amount = 0;
+        for (int shift = 0; position < amounts.size() && shift < 35; shift += 7) {
+            auto byte = amounts[position++];
+            amount |= (uint32_t) (byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return (int) amount;
+            }
+        }
+        return -1;
+    }
+
+    inline void Snapshot::write(ostream& stream) const {
+        int header[] = {count, minimum, maximum, width};
+        uint64_t length = amounts.size();
+        stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+        stream.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        stream.write(reinterpret_cast<const char*>(lows.data()), lows.size() * sizeof(uint64_t));
+        stream.write(reinterpret_cast<const char*>(highs.data()), highs.size() * sizeof(uint64_t));
+        stream.write(reinterpret_cast<const char*>(amounts.data()), amounts.size());
+    }
+
+    inline bool Snapshot::contains(int value) const {
+        auto index = lower(value);
+        return index < count && key(index) == value;
+    }
+
+    inline int Snapshot::amount(int value) const {
+        auto index = lower(value);
+        if (index == count || key(index) != value) {
+            return 0;
+        }
+        
+        auto position = offsets[index / BLOCK];
+        for (int i = index / BLOCK * BLOCK; i < index; i++) {
+            decode(position);
+        }
+        return decode(position);
+    }
+
+    inline long long Snapshot::rank(int value) const {
+        auto index = lower(value);
+        auto position = offsets[index / BLOCK];
+        auto rank = prefixes[index / BLOCK];
+        for (int i = index / BLOCK * BLOCK; i < index; i++) {
+            rank += decode(position);
+        }
+        return rank;
+    }
+
+    inline int Snapshot::select(long long index) const {
+        if (index < 0 || index >= total) {
+            throw invalid_argument("index is invalid");
+        }
+        
+        int block = (int) (upper_bound(prefixes.begin(), prefixes.end(), index) - prefixes.begin()) - 1;
+        auto position = offsets[block];
+        auto rank = prefixes[block];
+        int i = block * BLOCK;
+        for (rank += decode(position); rank <= index; rank += decode(position)) {
+            i++;
+        }
+        return key(i);
+    }
+
+    inline Snapshot::Iterator Snapshot::iterator() const {
+        return Iterator(this);
+    }
+
+    inline int Snapshot::nodes() const {
+        return count;
+    }
+
+    inline long long Snapshot::size() const {
+        return total;
+    }
+
+    inline Memory Snapshot::memory_usage() const {
+        Memory memory;
+        memory.nodes = (lows.size() + highs.size()) * sizeof(uint64_t) + amounts.size();
+        memory.overhead = (lows.capacity() - lows.size() + highs.capacity() - highs.size()) * sizeof(uint64_t) + amounts.capacity() - amounts.size();
+        memory.scratch = sizeof(Iterator);
+        memory.indexes = (ones.capacity() + zeros.capacity() + offsets.capacity()) * sizeof(uint64_t) + prefixes.capacity() * sizeof(long long);
+        return memory;
+    }
+
+
+    inline Snapshot::Iterator::Iterator(const Snapshot* snapshot)
+        : snapshot(snapshot), index(-1), position(0), offset(0), value(0), count(0) {}
+
+    inline bool Snapshot::Iterator::operator++() {
+        if (index + 1 >= snapshot->count) {
+            index = snapshot->count;
+            return false;
+        }
+        
+        index++;
+        position = snapshot->next(index == 0 ? 0 : position + 1);
+        value = (int) ((int64_t) snapshot->minimum + (int64_t) (((position - index) << snapshot->width) | snapshot->low(index)));
+        count = snapshot->decode(offset);
+        return true;
+    }
+
+    inline bool Snapshot::Iterator::operator++(int) {
+        return operator++();
+    }
+
+    inline int Snapshot::Iterator::get() const {
+        return value;
+    }
+
+    inline int Snapshot::Iterator::amount() const {
+        return count;
+    }
+
+}
+
+#endif /* SNAPSHOT_H */
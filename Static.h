@@ -0,0 +1,687 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2018 PohSeng#1.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   Static.h
+ * Author: Matthias Ngeo - S10172190F
+ * Author: Francis Koh - S10172072G
+ *
+ * Created on February 4, 2018, 4:20 PM
+ */
+
+#ifndef STATIC_H
+#define STATIC_H
+
+#include <iostream>
+#include <stdexcept>
+
+#include "Iterator.h"
+#include "Tree.h"
+
+using namespace std;
+
+namespace assignment {
+
+    /**
+     * Represents an AVL tree which holds at most the specified number of nodes in a fixed array inside
+     * the tree, and never allocates memory. Nodes refer to their children by indexes, where 0 represents
+     * the absence of a child, and are balanced using an explicit path like PackedAVLTree<T>.
+     *
+     * All operations except displaying the tree are constexpr, so that a tree may be built and queried
+     * at compile time, such as to embed a lookup table. The values must be of a literal type.
+     */
+    template <class T, int N>
+    class StaticAVLTree {
+        static_assert(N > 0, "StaticAVLTree requires a capacity of at least 1");
+        
+        private:
+            /**
+             * The maximum height of the tree, which is larger than the height of an AVL tree with 2^31 nodes.
+             */
+            static const int DEPTH = 64;
+            
+            /**
+             * Represents a node of the tree.
+             */
+            struct Slot {
+                T value;
+                int children[2];
+                int balance;
+                int amount;
+            };
+            
+            Slot slots[N + 1];
+            int used;
+            int available;
+            int root;
+            int values;
+            int total;
+            
+            /**
+             * SharedAVLTree reads the slots directly, since it must tolerate slots which are being modified.
+             */
+            template <class V, int M>
+            friend class SharedAVLTree;
+            
+            /**
+             * Returns the node which contains the specified value.
+             *
+             * @param value the value
+             * @return the node, or 0 if the tree does not contain the value
+             */
+            constexpr int find(const T& value) const;
+            
+            /**
+             * Replaces the child of the node at the specified depth of the path, or the root if the depth is 0,
+             * with the specified node.
+             *
+             * @param path the nodes from the root
+             * @param directions the direction taken from each node, where 0 is left and 1 is right
+             * @param depth the depth of the child to replace
+             * @param node the replacement
+             */
+            constexpr void link(const int* path, const int* directions, int depth, int node) noexcept;
+            
+            /**
+             * Lifts the child of the specified node in the specified direction above the node.
+             * Balances are left unchanged.
+             *
+             * @param node the node to rotate
+             * @param direction the direction of the child, where 0 is left and 1 is right
+             * @return the lifted child
+             */
+            constexpr int lift(int node, int direction) noexcept;
+            
+            /**
+             * Balances the subtree of the specified node, whose balance is -2 or 2, using a single rotation
+             * if its taller child leans in the same direction or is balanced; else a double rotation.
+             *
+             * @param node the node
+             * @param balance the balance of the node, either -2 or 2
+             * @return the root of the subtree after balancing
+             */
+            constexpr int rebalance(int node, int balance) noexcept;
+        
+        public:
+            /**
+             * Represents an iterator over the values in a StaticAVLTree, which follows the protocol of
+             * Iterator<T> but is returned by value.
+             *
+             * The iterator only holds the path from the root to the current node, so that its size is
+             * bounded by #DEPTH rather than by N. A level-by-level traversal therefore walks the tree once
+             * per level in depth-first order, skipping the nodes which are not at the current level.
+             */
+            class Iterator {
+                private:
+                    const StaticAVLTree* tree;
+                    Traversal traversal;
+                    int pending[DEPTH];
+                    int tail;
+                    int level;
+                    int current;
+                    
+                    /**
+                     * Moves the path to the next node at the specified level in depth-first order.
+                     *
+                     * @param level the level of the node, where 0 is the root
+                     * @param resume true if the search starts after the last node of the path; false if the
+                     *        last node of the path is included
+                     * @return true if there is such a node; else false
+                     */
+                    constexpr bool seek(int level, bool resume);
+                
+                public:
+                    /**
+                     * Constructs an Iterator over the specified tree with the specified traversal type.
+                     *
+                     * @param tree the tree
+                     * @param traversal the traversal type
+                     */
+                    constexpr Iterator(const StaticAVLTree* tree, Traversal traversal);
+                    
+                    /**
+                     * Iterates to the next value in the iteration.
+                     *
+                     * @return true if the iteration has more values; else false
+                     */
+                    constexpr bool operator++();
+                    
+                    /**
+                     * Iterates to the next value in the iteration.
+                     *
+                     * @return true if the iteration has more values; else false
+                     */
+                    constexpr bool operator++(int);
+                    
+                    /**
+                     * Returns the current value in the iteration.
+                     *
+                     * @return the current value
+                     */
+                    constexpr const T& get() const;
+                    
+                    /**
+                     * Returns the amount of the current value in the iteration.
+                     *
+                     * @return the amount of the current value
+                     */
+                    constexpr int amount() const;
+            };
+            
+            /**
+             * Constructs an empty StaticAVLTree.
+             *
+             * @implSpec
+             * Assigns each slot explicitly, since GCC does not treat a tree whose slots are only
+             * value-initialized as a constant expression.
+             */
+            constexpr StaticAVLTree() noexcept;
+            
+            /**
+             * Removes all values from the tree.
+             */
+            constexpr void clear() noexcept;
+            
+            /**
+             * Returns the height of the tree, which is the number of levels in the tree.
+             *
+             * @return the height of the tree, or 0 if the tree is empty
+             */
+            constexpr int height() const noexcept;
+            
+            /**
+             * Returns the memory used by the tree. Nodes which are not in use are counted as overhead.
+             *
+             * @return the memory used by the tree
+             */
+            Memory memory_usage() const;
+            
+            /**
+             * Adds the specified value if the tree contains the value or has room for another node.
+             *
+             * @implSpec
+             * Iterates through the nodes in the tree starting from the root while recording the path taken,
+             * and creates a node if the tree does not contain the value. Afterwards iterates through the path
+             * in reverse, updating the balances until the height of a subtree is unchanged or a subtree has
+             * been rotated.
+             *
+             * @param value the value to add
+             * @return true if the value was added; false if the tree is full
+             */
+            constexpr bool add(const T& value) noexcept;
+            
+            /**
+             * Removes the specified value.
+             *
+             * @implSpec
+             * Iterates through the nodes in the tree starting from the root while recording the path taken.
+             * If the node which contains the value has both a left and right child, the value and amount of
+             * its successor are moved into it, and the successor is removed instead. Afterwards iterates
+             * through the path in reverse, updating the balances until the height of a subtree is unchanged.
+             *
+             * @param value the value to remove
+             * @return true if the value was successfully removed; else false
+             */
+            constexpr bool remove(const T& value) noexcept;
+            
+            /**
+             * Returns whether the tree contains the specified value.
+             *
+             * @param value the value
+             * @return true if the tree contains the specified value; else false
+             */
+            constexpr bool contains(const T& value) const noexcept;
+            
+            /**
+             * Returns the number of times the specified value occurs in the tree.
+             *
+             * @param value the value
+             * @return the amount of the value, or 0 if the tree does not contain it
+             */
+            constexpr int amount(const T& value) const noexcept;
+            
+            /**
+             * Returns an iterator with the specified traversal type for the values in the tree.
+             *
+             * @param traversal the traversal type, or LEVEL if unspecified
+             * @return the iterator
+             */
+            constexpr Iterator iterator(Traversal traversal = Traversal::LEVEL) const;
+            
+            /**
+             * Returns the value of the node at the specified index in level-by-level order.
+             *
+             * @implSpec
+             * Iterates through the nodes level by level until the index is reached. Hence, this method takes
+             * O(n) time for each call, or O(n log(n)) time in the worst case since each level is found by
+             * walking the levels above it, and uses O(#DEPTH) stack regardless of N.
+             *
+             * @param index the index of the node
+             * @throws invalid_argument if the specified index is less than 0 or not less than the number of nodes
+             * @return the value of the node at the specified index
+             */
+            constexpr const T& operator[](int index) const;
+            
+            /**
+             * Displays the values of the specified tree in ascending order using the specified ostream.
+             *
+             * @param stream the ostream used to display the tree
+             * @param tree the tree to display
+             * @return the ostream
+             */
+            template <class V, int M>
+            friend ostream& operator<<(ostream& stream, const StaticAVLTree<V, M>& tree);
+            
+            /**
+             * Returns whether the tree has no room for another node.
+             *
+             * @return true if the tree holds N nodes; else false
+             */
+            constexpr bool full() const noexcept;
+            
+            /**
+             * Returns the number of nodes in the tree.
+             *
+             * @return the number of nodes in the tree, excluding duplicate values
+             */
+            constexpr int nodes() const noexcept;
+            
+            /**
+             * Returns the number of values in the tree.
+             *
+             * @return the number of values in the tree, including duplicate values
+             */
+            constexpr int size() const noexcept;
+    };
+
+    template <class T, int N>
+    constexpr StaticAVLTree<T, N>::StaticAVLTree() noexcept : slots(), used(0), available(0), root(0), values(0), total(0) {
+        for (auto& slot : slots) {
+            slot = Slot {T(), {0, 0}, 0, 0};
+        }
+    }
+
+    template <class T, int N>
+    constexpr void StaticAVLTree<T, N>::clear() noexcept {
+        used = 0;
+        available = 0;
+        root = 0;
+        values = 0;
+        total = 0;
+    }
+
+    template <class T, int N>
+    constexpr int StaticAVLTree<T, N>::find(const T& value) const {
+        auto node = root;
+        while (node) {
+            auto& current = slots[node];
+            if (value < current.value) {
+                node = current.children[0];
+            
+            } else if (current.value < value) {
+                node = current.children[1];
+            
+            } else {
+                return node;
+            }
+        }
+        return 0;
+    }
+
+    template <class T, int N>
+    constexpr void StaticAVLTree<T, N>::link(const int* path, const int* directions, int depth, int node) noexcept {
+        if (depth == 0) {
+            root = node;
+        
+        } else {
+            slots[path[depth - 1]].children[directions[depth - 1]] = node;
+        }
+    }
+
+    template <class T, int N>
+    constexpr int StaticAVLTree<T, N>::lift(int node, int direction) noexcept {
+        auto child = slots[node].children[direction];
+        slots[node].children[direction] = slots[child].children[1 - direction];
+        slots[child].children[1 - direction] = node;
+        return child;
+    }
+
+    template <class T, int N>
+    constexpr int StaticAVLTree<T, N>::rebalance(int node, int balance) noexcept {
+        int direction = balance > 0;
+        int sign = balance > 0 ? 1 : -1;
+        auto child = slots[node].children[direction];
+        auto leaning = slots[child].balance * sign;
+        
+        if (leaning >= 0) {
+            auto top = lift(node, direction);
+            auto lower = 1 - leaning;
+            slots[node].balance = lower * sign;
+            slots[top].balance = (leaning - 1 + (lower < 0 ? lower : 0)) * sign;
+            return top;
+        }
+        
+        auto grandchild = slots[child].children[1 - direction];
+        auto inner = slots[grandchild].balance * sign;
+        slots[node].children[direction] = lift(child, 1 - direction);
+        auto top = lift(node, direction);
+        
+        slots[node].balance = inner > 0 ? -sign : 0;
+        slots[child].balance = inner < 0 ? sign : 0;
+        slots[top].balance = 0;
+        return top;
+    }
+
+    template <class T, int N>
+    constexpr int StaticAVLTree<T, N>::height() const noexcept {
+        int height = 0;
+        for (auto node = root; node; height++) {
+            node = slots[node].children[slots[node].balance >= 0];
+        }
+        return height;
+    }
+
+    template <class T, int N>
+    Memory StaticAVLTree<T, N>::memory_usage() const {
+        Memory memory;
+        memory.nodes = values * sizeof(Slot);
+        memory.overhead = sizeof(*this) - memory.nodes;
+        memory.scratch = sizeof(Iterator);
+        memory.indexes = 0;
+        return memory;
+    }
+
+    template <class T, int N>
+    constexpr bool StaticAVLTree<T, N>::add(const T& value) noexcept {
+        int path[DEPTH] = {};
+        int directions[DEPTH] = {};
+        int depth = 0;
+        
+        for (auto node = root; node; depth++) {
+            auto& current = slots[node];
+            if (!(value < current.value) && !(current.value < value)) {
+                current.amount++;
+                total++;
+                return true;
+            }
+            
+            path[depth] = node;
+            directions[depth] = current.value < value;
+            node = current.children[directions[depth]];
+        }
+        
+        int added = available;
+        if (added) {
+            available = slots[added].children[0];
+        
+        } else if (used < N) {
+            added = ++used;
+        
+        } else {
+            return false;
+        }
+        
+        slots[added] = Slot {value, {0, 0}, 0, 1};
+        link(path, directions, depth, added);
+        values++;
+        total++;
+        
+        for (int i = depth - 1; i >= 0; i--) {
+            auto node = path[i];
+            auto balance = slots[node].balance + (directions[i] ? 1 : -1);
+            if (balance == 0) {
+                slots[node].balance = 0;
+                break;
+            
+            } else if (balance == 1 || balance == -1) {
+                slots[node].balance = balance;
+            
+            } else {
+                link(path, directions, i, rebalance(node, balance));
+                break;
+            }
+        }
+        
+        return true;
+    }
+
+    template <class T, int N>
+    constexpr bool StaticAVLTree<T, N>::remove(const T& value) noexcept {
+        int path[DEPTH] = {};
+        int directions[DEPTH] = {};
+        int depth = 0;
+        
+        auto node = root;
+        while (node && ((value < slots[node].value) || (slots[node].value < value))) {
+            path[depth] = node;
+            directions[depth] = slots[node].value < value;
+            node = slots[node].children[directions[depth++]];
+        }
+        
+        if (!node) {
+            return false;
+        
+        } else if (slots[node].amount > 1) {
+            slots[node].amount--;
+            total--;
+            return true;
+        }
+        
+        if (slots[node].children[0] && slots[node].children[1]) {
+            auto target = node;
+            path[depth] = node;
+            directions[depth++] = 1;
+            node = slots[node].children[1];
+            
+            while (slots[node].children[0]) {
+                path[depth] = node;
+                directions[depth++] = 0;
+                node = slots[node].children[0];
+            }
+            
+            slots[target].value = slots[node].value;
+            slots[target].amount = slots[node].amount;
+        }
+        
+        auto child = slots[node].children[0] ? slots[node].children[0] : slots[node].children[1];
+        link(path, directions, depth, child);
+        slots[node].children[0] = available;
+        available = node;
+        values--;
+        total--;
+        
+        for (int i = depth - 1; i >= 0; i--) {
+            auto node = path[i];
+            auto balance = slots[node].balance - (directions[i] ? 1 : -1);
+            if (balance == 1 || balance == -1) {
+                slots[node].balance = balance;
+                break;
+            
+            } else if (balance == 0) {
+                slots[node].balance = 0;
+            
+            } else {
+                auto top = rebalance(node, balance);
+                link(path, directions, i, top);
+                if (slots[top].balance != 0) {
+                    break;
+                }
+            }
+        }
+        
+        return true;
+    }
+
+    template <class T, int N>
+    constexpr bool StaticAVLTree<T, N>::contains(const T& value) const noexcept {
+        return find(value) != 0;
+    }
+
+    template <class T, int N>
+    constexpr int StaticAVLTree<T, N>::amount(const T& value) const noexcept {
+        auto node = find(value);
+        return node ? slots[node].amount : 0;
+    }
+
+    template <class T, int N>
+    constexpr typename StaticAVLTree<T, N>::Iterator StaticAVLTree<T, N>::iterator(Traversal traversal) const {
+        return Iterator(this, traversal);
+    }
+
+    template <class T, int N>
+    constexpr const T& StaticAVLTree<T, N>::operator[](int index) const {
+        if (index < 0 || index >= values) {
+            throw invalid_argument("index is invalid");
+        }
+        
+        auto iterator = this->iterator(Traversal::LEVEL);
+        for (int i = 0; i <= index; i++) {
+            iterator++;
+        }
+        return iterator.get();
+    }
+
+    template <class T, int N>
+    ostream& operator<<(ostream& stream, const StaticAVLTree<T, N>& tree) {
+        auto iterator = tree.iterator(Traversal::ASCENDING);
+        while (iterator++) {
+            for (int i = 0; i < iterator.amount(); i++) {
+                stream << iterator.get() << endl;
+            }
+        }
+        return stream;
+    }
+
+    template <class T, int N>
+    constexpr bool StaticAVLTree<T, N>::full() const noexcept {
+        return values == N;
+    }
+
+    template <class T, int N>
+    constexpr int StaticAVLTree<T, N>::nodes() const noexcept {
+        return values;
+    }
+
+    template <class T, int N>
+    constexpr int StaticAVLTree<T, N>::size() const noexcept {
+        return total;
+    }
+
+
+    template <class T, int N>
+    constexpr StaticAVLTree<T, N>::Iterator::Iterator(const StaticAVLTree* tree, Traversal traversal)
+        : tree(tree), traversal(traversal), pending(), tail(0), level(-1), current(0) {
+        if (traversal == Traversal::ASCENDING) {
+            for (auto node = tree->root; node; node = tree->slots[node].children[0]) {
+                pending[tail++] = node;
+            }
+        }
+    }
+
+    template <class T, int N>
+    constexpr bool StaticAVLTree<T, N>::Iterator::seek(int level, bool resume) {
+        bool backtrack = resume;
+        while (tail > 0) {
+            if (!backtrack) {
+                if (tail - 1 == level) {
+                    return true;
+                }
+                
+                auto& children = tree->slots[pending[tail - 1]].children;
+                auto child = children[0] ? children[0] : children[1];
+                if (child) {
+                    pending[tail++] = child;
+                    continue;
+                }
+            }
+            
+            auto child = pending[--tail];
+            backtrack = true;
+            if (tail > 0) {
+                auto& children = tree->slots[pending[tail - 1]].children;
+                if (child == children[0] && children[1]) {
+                    pending[tail++] = children[1];
+                    backtrack = false;
+                }
+            }
+        }
+        return false;
+    }
+
+    template <class T, int N>
+    constexpr bool StaticAVLTree<T, N>::Iterator::operator++() {
+        if (traversal == Traversal::ASCENDING) {
+            if (tail == 0) {
+                current = 0;
+                return false;
+            }
+            
+            current = pending[--tail];
+            for (auto node = tree->slots[current].children[1]; node; node = tree->slots[node].children[0]) {
+                pending[tail++] = node;
+            }
+            return true;
+        }
+        
+        if (level == -1 && tree->root) {
+            pending[tail++] = tree->root;
+            level = 0;
+        
+        } else if (tail == 0 || !seek(level, true)) {
+            tail = 0;
+            if (level >= 0 && level + 1 < DEPTH) {
+                pending[tail++] = tree->root;
+                level++;
+            }
+            
+            if (tail == 0 || !seek(level, false)) {
+                tail = 0;
+                level = DEPTH;
+                current = 0;
+                return false;
+            }
+        }
+        
+        current = pending[tail - 1];
+        return true;
+    }
+
+    template <class T, int N>
+    constexpr bool StaticAVLTree<T, N>::Iterator::operator++(int) {
+        return operator++();
+    }
+
+    template <class T, int N>
+    constexpr const T& StaticAVLTree<T, N>::Iterator::get() const {
+        return tree->slots[current].value;
+    }
+
+    template <class T, int N>
+    constexpr int StaticAVLTree<T, N>::Iterator::amount() const {
+        return tree->slots[current].amount;
+    }
+
+}
+
+#endif /* STATIC_H */
@@ -33,97 +33,583 @@
 #ifndef TREE_H
 #define TREE_H
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+#include "Arena.h"
+#include "Augment.h"
+#include "Balance.h"
+#include "Filter.h"
+#include "Index.h"
 #include "Node.h"
 #include "Iterator.h"
+#include "Pool.h"
 
 
 using namespace std;
 
 namespace assignment {
     
+    /**
+     * Represents the memory used by a tree, in bytes. The memory owned by the values themselves,
+     * such as the contents of strings, is excluded.
+     */
+    struct Memory {
+        /**
+         * The memory used by the nodes.
+         */
+        size_t nodes;
+        
+        /**
+         * The estimated memory used by the allocator and reference counts for each node.
+         */
+        size_t overhead;
+        
+        /**
+         * The maximum memory used by an iterator over the tree.
+         */
+        size_t scratch;
+        
+        /**
+         * The memory used by auxiliary indexes over the nodes, such as the Bloom filter, hash index and level-order array.
+         */
+        size_t indexes;
+        
+        /**
+         * Returns the total memory used.
+         * 
+         * @return the sum of the memory used by the nodes, the overhead, the scratch and the indexes
+         */
+        size_t total() const {
+            return nodes + overhead + scratch + indexes;
+        }
+    };
+    
+    
+    /**
+     * Represents the shape of a tree. The depth of the root is 0.
+     */
+    struct Shape {
+        /**
+         * The number of levels in the tree, or 0 if the tree is empty.
+         */
+        int height;
+        
+        /**
+         * The number of nodes without children.
+         */
+        int leaves;
+        
+        /**
+         * The average depth of the nodes.
+         */
+        double averageDepth;
+        
+        /**
+         * The maximum depth of the nodes, or -1 if the tree is empty.
+         */
+        int maximumDepth;
+        
+        /**
+         * The number of nodes at each depth.
+         */
+        vector<int> depths;
+        
+        /**
+         * The number of nodes with each balance. The meaning of the balance depends on the balancing policy.
+         */
+        map<int, int> balances;
+        
+        /**
+         * The number of nodes with each amount.
+         */
+        map<int, int> amounts;
+        
+        /**
+         * The fraction of values which are duplicates of another value, between 0 and 1.
+         */
+        double duplicates;
+    };
+    
+    
     /**
      * Represents an AVL tree. The implementation is non-recursive and provides 
      * a guaranteed time complexity of O(log(n)) for the basic operations (add, remove and contains), 
      * and a guaranteed time complexity of O(n) for additional operations (operator<< and operator[]).
+     * 
+     * The tree is balanced using the specified balancing policy, which is AVLBalance if unspecified.
+     * RedBlackBalance and WAVLBalance trade a taller tree for fewer rotations during removal.
+     * 
+     * The tree keeps the aggregate of each subtree using the specified augmentation, or none if 
+     * unspecified, which allows aggregates of ranges of values to be computed in O(log(n)).
      */
-    template <class T>
+    template <class T, class Balance = AVLBalance, class Augment = NoAugment>
     class AVLTree {
         private:
+            /**
+             * The number of lookups which are advanced in lock-step.
+             */
+            static const int BATCH = 16;
+            
+            /**
+             * The minimum number of nodes for which the Bloom filter is sized.
+             */
+            static const int FILTER = 1024;
+            
             shared_ptr<Node<T>> root;
+            shared_ptr<Node<T>> rightmost;
             int values;
             int total;
             
+            unique_ptr<BloomFilter> bloom;
+            unique_ptr<HashIndex<T>> table;
+            uint64_t (*hasher)(const T&);
+            double rate;
+            int stale;
+            
+            vector<Node<T>*> order;
+            bool lazy;
+            int tombstones;
+            bool relaxed;
+            bool deferred;
+            double slack;
+            int peak;
+            
+            Arena* arena;
+            deque<shared_ptr<Node<T>>> compacting;
+            
             
             /**
-             * Creates and adds the child node with the specified value, balance and parent
-             * before balancing the tree, if the child is null; else returns the child.
+             * Adds the specified value, which is either copied or moved into the node
+             * depending on the value category of the argument.
+             * 
+             * @implSpec
+             * Creates the root if the tree is empty; else iterates through the nodes 
+             * in the tree starting from the node returned by #start(const T& value, shared_ptr<Node<T>> hint)
+             * while the current node is not null. If the value is either larger than or smaller than the 
+             * current node and the respective child is null, delegate the addition 
+             * to #add(V&& value, shared_ptr<Node<T>> parent, shared_ptr<Node<T>> child).
+             * Otherwise increase the amount of the current node and return.
              * 
              * @param value the value to add
-             * @param parent the parent of the child node
-             * @param child the child node
-             * @param the balance to add if the child is created
-             * @return the child node if not null; else null
+             * @param hint the node near which the value is expected to be added, or null if unspecified
+             * @return the node which contains the value
              */
-            shared_ptr<Node<T>> add(T value, shared_ptr<Node<T>> parent, shared_ptr<Node<T>>& child, int balance);
+            template <class V>
+            shared_ptr<Node<T>> insert(V&& value, shared_ptr<Node<T>> hint);
             
             /**
-             * Balances the tree after addition.
+             * Returns the node from which the search for the position of the specified value starts.
              * 
              * @implSpec
-             * Iterates through the parents of the nodes, starting from the specified node 
-             * and updates the balance each time before delegating rotation to appropriate
-             * method which depends on the balance.
+             * Returns the right-most node if the value is not smaller than it, so that values which are 
+             * added in ascending order are appended without descending from the root. Otherwise iterates 
+             * through the parents of the nodes, starting from the hint, until the value lies between the 
+             * nearest ancestors which bound the subtree of the current node, and returns the current node.
+             * Returns the root if the hint is null.
              * 
-             * A balance of 0 indicates that the tree has been fully balanced and the loop terminates.
-             * 
-             * @param node the parent of the node which was added
-             * @param the resultant balance after the addition
+             * @param value the value to add
+             * @param hint the node near which the value is expected to be added, or null
+             * @return the node from which to start the search
              */
-            void balanceAddition(shared_ptr<Node<T>> node, int balance);
+            shared_ptr<Node<T>> start(const T& value, shared_ptr<Node<T>> hint);
             
+            /**
+             * Creates and adds the child node with the specified value and parent
+             * before balancing the tree. The child must be null. If relaxed balancing is enabled, 
+             * delegates to #bound(shared_ptr<Node<T>> node) instead of balancing the tree.
+             * 
+             * @param value the value to add
+             * @param parent the parent of the child node
+             * @param child the child node
+             * @return the created child node
+             */
+            template <class V>
+            shared_ptr<Node<T>> add(V&& value, shared_ptr<Node<T>> parent, shared_ptr<Node<T>>& child);
             
             /**
              * Removes the specified node and balances the tree.
              * 
+             * @implSpec
+             * Delegates removal to #removeMiddle(shared_ptr<Node<T>> node) if the node has both a left and
+             * right child; else replaces the node with its only child, if any, before delegating balancing
+             * to the balancing policy. If relaxed balancing is enabled, balancing is skipped unless the tree
+             * has shrunk to less than half of its largest size since it was last balanced, in which case
+             * the tree is balanced using #rebalance().
+             * 
              * @param node the node to remove
              */
             void remove(shared_ptr<Node<T>> node);
             
             /**
-             * Removes the specified node which has both a left and right child, and balances the tree.
+             * Creates a copy of the specified node, including its aggregate, without its children.
+             * 
+             * @param node the node to copy
+             * @param parent the parent of the copy
+             * @return the copy
+             */
+            static shared_ptr<Node<T>> duplicate(const Node<T>& node, shared_ptr<Node<T>> parent);
+            
+            /**
+             * Creates a deep copy of the subtree of the specified node.
              * 
              * @implSpec
-             * Iterates through the left children of the specified node's right child while it exists
-             * before replacing the specified node with the left-most child if the right child has a 
-             * left child; else replaces the specified node with its right child.
+             * Iterates through the nodes of the subtree using a stack of the nodes which are yet to be copied
+             * together with their copies, and copies the children of each node. Hence this method takes O(n) 
+             * time and does not recurse.
              * 
-             * @param node the node to remove
+             * @param source the root of the subtree to copy, or null
+             * @param parent the parent of the copy
+             * @return the copy, or null if the source is null
              */
-            void removeMiddle(shared_ptr<Node<T>> node);
+            static shared_ptr<Node<T>> copy(const shared_ptr<Node<T>>& source, shared_ptr<Node<T>> parent);
+            
+            /**
+             * Creates a deep copy of the subtree of the specified node using the specified number of threads.
+             * 
+             * @implSpec
+             * Copies the specified node before copying the left subtree on a new thread with half of the 
+             * threads and the right subtree on the current thread with the remaining threads. Delegates to
+             * #copy(const shared_ptr<Node<T>>& source, shared_ptr<Node<T>> parent) if only one thread remains.
+             * 
+             * @param source the root of the subtree to copy, or null
+             * @param parent the parent of the copy
+             * @param threads the number of threads
+             * @return the copy, or null if the source is null
+             */
+            static shared_ptr<Node<T>> copy(const shared_ptr<Node<T>>& source, shared_ptr<Node<T>> parent, int threads);
+            
+            /**
+             * Returns the number of levels of the tree which are split into tasks by the parallel operations,
+             * so that each thread of the specified pool receives about 8 subtrees.
+             *
+             * @param pool the pool
+             * @return the number of levels
+             */
+            static int levels(const ThreadPool& pool);
+            
+            /**
+             * Calls the specified function with each node in the subtree of the specified node in ascending order.
+             *
+             * @implSpec
+             * Iterates through the nodes using a stack of the nodes whose left subtrees are being visited.
+             *
+             * @param node the root of the subtree
+             * @param function the function to call with the value and amount of each node
+             */
+            template <class Function>
+            static void visit(const shared_ptr<Node<T>>& node, Function& function);
+            
+            /**
+             * Splits the subtree of the specified node into tasks on the specified pool, calling the specified
+             * function with each subtree below the specified number of levels and with each node above them.
+             *
+             * @implSpec
+             * Processes the right subtree in a task and the node and left subtree on the current thread using
+             * ThreadPool#join(First first, Second second). Since the tree is balanced, the subtrees are of 
+             * similar size.
+             *
+             * @param node the root of the subtree
+             * @param function the function to call with a node and whether its whole subtree is to be processed
+             * @param pool the pool
+             * @param levels the number of levels to split
+             */
+            template <class Function>
+            static void split(const shared_ptr<Node<T>>& node, Function& function, ThreadPool& pool, int levels);
+            
+            /**
+             * Combines the mapped values in the subtree of the specified node in ascending order with the
+             * specified initial result.
+             *
+             * @implSpec
+             * Iterates through the nodes using a stack of the nodes whose left subtrees are being visited.
+             *
+             * @param node the root of the subtree
+             * @param result the initial result
+             * @param map the function which maps the value and amount of a node to a result
+             * @param combine the function which combines two adjacent results
+             * @return the combined result
+             */
+            template <class R, class Map, class Combine>
+            static R fold(const shared_ptr<Node<T>>& node, R result, Map& map, Combine& combine);
+            
+            /**
+             * Combines the mapped values in the subtree of the specified node in ascending order, splitting
+             * the specified number of levels into tasks on the specified pool.
+             *
+             * @param node the root of the subtree
+             * @param identity the result of an empty subtree
+             * @param map the function which maps the value and amount of a node to a result
+             * @param combine the function which combines two adjacent results
+             * @param pool the pool
+             * @param levels the number of levels to split
+             * @return the combined result
+             */
+            template <class R, class Map, class Combine>
+            static R fold(const shared_ptr<Node<T>>& node, const R& identity, Map& map, Combine& combine, ThreadPool& pool, int levels);
+            
+            /**
+             * Looks up the specified values in lock-step, calling the specified function with the index 
+             * of each value, the node which contains it, or null if absent, and the node which contains 
+             * the smallest value which is larger than or equal to it, or null if there is none.
+             * 
+             * @implSpec
+             * Keeps up to #BATCH lookups in flight, each represented by the link to its next node. Each round 
+             * advances every lookup in flight by one level and prefetches the next node, so that the cache 
+             * misses of independent lookups overlap instead of occurring one after another. A lookup which 
+             * completes is immediately replaced by the next value.
+             * 
+             * If filtered, values which the Bloom filter rules out are completed immediately without walking 
+             * the tree, in which case the node and the lower node are both null. Likewise, if filtered and the
+             * hash index is enabled, every value is looked up in the index instead, and the lower node is null.
+             * 
+             * @param values the values to look up
+             * @param function the function to call for each value
+             * @param filtered whether to consult the Bloom filter and hash index, which must be false if the lower 
+             *        node is used
+             */
+            template <class Function>
+            void batch(const vector<T>& values, Function function, bool filtered);
+            
+            /**
+             * Returns whether the Bloom filter rules out the specified value.
+             * 
+             * @param value the value
+             * @return true if the filter is enabled and the tree definitely does not contain the value; else false
+             */
+            bool absent(const T& value);
+            
+            /**
+             * Returns the node which contains the specified value.
+             * 
+             * @implSpec
+             * Returns null if the Bloom filter rules out the value. Otherwise looks up the value in the hash
+             * index if enabled, or iterates through the nodes in the tree starting from the root.
+             * 
+             * @param value the value
+             * @return the node which contains the value, or null if the tree does not contain it
+             */
+            shared_ptr<Node<T>> locate(const T& value);
+            
+            /**
+             * Returns the link in the parent of the specified node, or the root, which owns the specified node.
+             * 
+             * @param node a node in the tree
+             * @return the owning link
+             */
+            const shared_ptr<Node<T>>& owner(Node<T>* node);
+            
+            /**
+             * Records the specified node, which was just added to the tree, in the hash index and Bloom filter 
+             * if enabled.
+             * 
+             * @implSpec
+             * Delegates to #rebuild() instead of adding the node to the filter if the tree has outgrown the 
+             * capacity of the filter or if too many nodes have been removed since the filter was last rebuilt.
+             * 
+             * @param node the added node
+             */
+            void track(const shared_ptr<Node<T>>& node);
+            
+            /**
+             * Records that the specified node was removed from the tree, removing it from the hash index if 
+             * enabled. Since values cannot be removed from a Bloom filter, the removed node is counted as stale 
+             * and the filter is rebuilt once the stale nodes exceed half of its capacity.
+             * 
+             * @param node the removed node
+             */
+            void untrack(Node<T>* node);
+            
+            /**
+             * Recreates the Bloom filter with a capacity of twice the number of nodes, and adds the value
+             * of every node. This takes O(n) time, which is amortized over the additions and removals 
+             * which trigger it.
+             */
+            void rebuild();
+            
+            /**
+             * Recreates the hash index and adds every node.
+             */
+            void reindex();
+            
+            /**
+             * Calls the specified function with every node in the tree, in pre-order.
+             * 
+             * @implSpec
+             * Iterates through the nodes using a stack of the nodes which are yet to be visited.
+             * 
+             * @param function the function to call with each node
+             */
+            template <class Function>
+            void each(Function function);
+            
+            /**
+             * Builds a balanced subtree from the specified range of sorted nodes by taking the middle node as
+             * the root of the subtree and building its left and right subtrees from the remaining nodes on 
+             * either side. The balances of the nodes are set by the balancing policy.
+             * 
+             * @param nodes the sorted nodes, which have no parents or children
+             * @param from the index of the first node in the range
+             * @param to the index after the last node in the range
+             * @param depth the depth of the root of the subtree
+             * @param levels the height of the whole tree
+             * @param height the height of the built subtree, which is set by this method
+             * @return the root of the subtree, or null if the range is empty
+             */
+            static shared_ptr<Node<T>> build(const vector<shared_ptr<Node<T>>>& nodes, int from, int to, int depth, int levels, int& height);
+            
+            /**
+             * Builds a balanced tree from the specified sorted nodes using
+             * #build(const vector<shared_ptr<Node<T>>>& nodes, int from, int to, int depth, int levels, int& height)
+             * in O(n) time.
+             * 
+             * @param nodes the sorted nodes, which have no parents or children
+             * @return the root of the tree, or null if there are no nodes
+             */
+            static shared_ptr<Node<T>> build(const vector<shared_ptr<Node<T>>>& nodes);
+            
+            /**
+             * Returns the node which contains the smallest value larger than the value of the specified node.
+             * 
+             * @param node the node
+             * @return the successor, or null if the node contains the largest value
+             */
+            static shared_ptr<Node<T>> successor(shared_ptr<Node<T>> node);
+            
+            /**
+             * Lists the nodes in the subtree of the specified node in ascending order and detaches them 
+             * from each other and from the parent of the subtree.
+             * 
+             * @param node the root of the subtree, or null
+             * @param nodes the list to which the nodes are appended
+             */
+            static void flatten(shared_ptr<Node<T>> node, vector<shared_ptr<Node<T>>>& nodes);
+            
+            /**
+             * Returns the number of nodes in the subtree of the specified node, including tombstones.
+             * 
+             * @param node the root of the subtree, or null
+             * @return the number of nodes in the subtree
+             */
+            static int count(Node<T>* node);
+            
+            /**
+             * Returns the largest height which relaxed balancing allows a subtree with the specified number
+             * of nodes to have, which is (1 + slack) * log2(size) + 1 rounded down.
+             * 
+             * @param size the number of nodes in the subtree
+             * @return the largest allowed height
+             */
+            int limit(int size) const;
+            
+            /**
+             * Restores the height bound of relaxed balancing after the specified leaf was added without 
+             * balancing the tree.
+             * 
+             * @implSpec
+             * Returns if the depth of the leaf is within the height allowed by #limit(int size) for the 
+             * whole tree. Otherwise iterates through the ancestors of the leaf, counting the nodes in their
+             * subtrees, until an ancestor is found whose subtree is taller than allowed for its size, which
+             * is at the latest the root. The subtree of that ancestor is then rebuilt using 
+             * #reshape(shared_ptr<Node<T>> node). As in a scapegoat tree, the time spent rebuilding is 
+             * amortized over the additions which unbalanced the subtree, which takes O(log(n)) amortized time.
+             * 
+             * @param node the added leaf
+             */
+            void bound(shared_ptr<Node<T>> node);
             
             /**
-             * Balances the tree after removal.
+             * Rebuilds the subtree of the specified node as a balanced subtree in its place.
              * 
              * @implSpec
-             * Iterates through the parents of the nodes, starting from the specified node 
-             * and updates the balance each time before delegating rotation to appropriate
-             * method which depends on the balance.
+             * Flattens the subtree using #flatten(shared_ptr<Node<T>> node, vector<shared_ptr<Node<T>>>& nodes)
+             * and rebuilds it using #build(const vector<shared_ptr<Node<T>>>& nodes), which takes O(m) time, where m is the number of nodes in the subtree.
+             * 
+             * @param node the root of the subtree
+             */
+            void reshape(shared_ptr<Node<T>> node);
+            
+            /**
+             * Replaces the specified node with a copy allocated from the arena of the compaction in progress,
+             * which takes over the value of the node instead of copying it. The node is detached from the tree.
+             * 
+             * @param node the node to relocate
+             * @return the copy which replaces the node
+             */
+            shared_ptr<Node<T>> relocate(shared_ptr<Node<T>> node);
+            
+            /**
+             * Returns the estimated memory used by the allocator for an object of the specified size which is
+             * allocated together with its reference counts using make_shared, excluding the object itself.
+             * 
+             * @param bytes the size of the object
+             * @return the estimated overhead
+             */
+            static size_t overhead(size_t bytes);
+            
+            /**
+             * Returns the height of the tree using the balances of the nodes.
+             * 
+             * @return the height of the tree
+             */
+            int height(AVLBalance*);
+            
+            /**
+             * Returns the height of the tree using #shape().
+             * 
+             * @return the height of the tree
+             */
+            template <class B>
+            int height(B*);
+            
+            /**
+             * Recomputes the aggregates of the specified node and its ancestors, starting from the specified node.
+             * Does nothing if the tree is not augmented.
              * 
-             * A balance of either 1 or -1 indicates that the tree has been balanced.
+             * @param node the node to update, or null
+             */
+            void update(shared_ptr<Node<T>> node);
+            
+            /**
+             * Replaces the specified node with the specified replacement, which may be null,
+             * in the parent of the node, or as the root if the node is the root.
              * 
-             * @param node the parent of the node which was removed
-             * @param the resultant balance after the removal
+             * @param node the node to replace
+             * @param replacement the node which replaces the specified node
              */
-            void balanceRemoval(shared_ptr<Node<T>> node, int balance);
+            void relink(shared_ptr<Node<T>> node, shared_ptr<Node<T>> replacement);
             
+            /**
+             * Removes the specified node which has both a left and right child, and balances the tree.
+             * 
+             * @implSpec
+             * Iterates through the left children of the specified node's right child while it exists
+             * before replacing the specified node with the left-most child if the right child has a 
+             * left child; else replaces the specified node with its right child. The replacement takes
+             * over the balance of the specified node, and the balancing policy is notified as if the
+             * replacement had been removed from its original position instead.
+             * 
+             * @param node the node to remove
+             */
+            void removeMiddle(shared_ptr<Node<T>> node);
             
             /**
              * Sets the specified node as the left child of its right child, before
              * setting the parent of the specified node as the parent of its right child
-             * and updating the balance of the right child.
+             * and updating the aggregates of both nodes.
+             * The balances of both nodes are left to the balancing policy.
              * 
              * @param node the node to rotate
              * @return the right child of the specified node
@@ -133,7 +619,8 @@ namespace assignment {
             /**
              * Sets the specified node as the right child of its left child, before
              * setting the parent of the specified node as the parent of its left child
-             * and updating the balance of the left child.
+             * and updating the aggregates of both nodes.
+             * The balances of both nodes are left to the balancing policy.
              * 
              * @param node the node to rotate
              * @return the left child of the specified node
@@ -190,6 +677,8 @@ namespace assignment {
             shared_ptr<Node<T>> rotateRightLeft(shared_ptr<Node<T>> node);
             
             
+            friend Balance;
+            
         public:
             /**
              * Constructs an empty AVL tree.
@@ -197,187 +686,1503 @@ namespace assignment {
             AVLTree();
             
             /**
-             * Adds the specified value.
+             * Constructs an AVL tree which is a deep copy of the specified tree.
              * 
              * @implSpec
-             * Creates the root if the tree is empty; else iterates through the nodes 
-             * in the tree starting from the root while the current node is not null. 
-             * If the value is either larger than or smaller than the current node, delegate the addition 
-             * to #add(T value, shared_ptr<Node<T>> parent, shared_ptr<Node<T>> child, int balance).
-             * Otherwise increase the amount of the current node and return.
+             * Delegates to #copy(const shared_ptr<Node<T>>& source, shared_ptr<Node<T>> parent). The structure,
+             * balances and amounts of the specified tree are preserved, and no rebalancing takes place.
              * 
-             * @param value the value to add
+             * @param other the tree to copy
+             */
+            AVLTree(const AVLTree<T, Balance, Augment>& other);
+            
+            /**
+             * Constructs an AVL tree which takes over the nodes of the specified tree, leaving it empty.
+             * 
+             * @param other the tree to move
+             */
+            AVLTree(AVLTree<T, Balance, Augment>&& other) noexcept;
+            
+            /**
+             * Replaces the values in this tree with a deep copy of the specified tree.
+             * 
+             * @param other the tree to copy
              * @return this
              */
-            AVLTree<T>& add(T value);
+            AVLTree<T, Balance, Augment>& operator=(const AVLTree<T, Balance, Augment>& other);
             
             /**
-             * Returns whether the tree contains the specified value.             * 
+             * Replaces the values in this tree with the nodes of the specified tree, leaving it empty.
              * 
-             * @param value the value which the tree contains
-             * @param stream the ostream used to display the path taken, or cin if unspecified
-             * @return true if the tree contains the specified value; else false
+             * @param other the tree to move
+             * @return this
              */
-            bool contains(T value, ostream& stream = cout);
+            AVLTree<T, Balance, Augment>& operator=(AVLTree<T, Balance, Augment>&& other) noexcept;
             
             /**
-             * Removes the specified value.
+             * Returns a deep copy of this tree which is created using the specified number of threads.
              * 
              * @implSpec
-             * Iterates through the nodes in the tree starting from the root while the current node is not null.
-             * If the node is smaller than or larger than the value set the respective child nodes as the next node.
-             * Otherwise if the node is equal to the specified value and the node amount is 1, delegates removal 
-             * to #remove(shared_ptr<Node<T>> node), else decrease the amount and return.
+             * Delegates to #copy(const shared_ptr<Node<T>>& source, shared_ptr<Node<T>> parent, int threads).
              * 
-             * @param value the value to remove
-             * @return true if the value was successfully removed; else false
+             * @param threads the number of threads
+             * @return the copy
              */
-            bool remove(T value);
+            AVLTree<T, Balance, Augment> clone(int threads) const;
             
             /**
-             * Returns an iterator with the specified traversal type for the elements in the tree.
+             * Destroys the AVL tree and all of its nodes.
+             */
+            ~AVLTree();
+            
+            /**
+             * Removes all values from the tree.
              * 
-             * @param traversal the traversal type, or level-by-level if unspecified
-             * @throws invalid_argument if the traversal type is unsupported
-             * @return the iterator
+             * @implSpec
+             * Iterates through the nodes starting from the root, descending to the left child, or to the
+             * right child if the left child is null, until a leaf is reached. The leaf is then detached from 
+             * its parent and freed before continuing from the parent. Since each node is freed only after its
+             * children, the nodes are freed without recursion in O(n) time, and the references between parent
+             * and child nodes do not keep the nodes alive.
+             * 
+             * Nodes which are still referenced outside of the tree, such as by iterators, are detached.
              */
-            shared_ptr<Iterator<T>> iterator(Traversal traversal = Traversal::LEVEL);
+            void clear();
             
             /**
-             * Returns the value of the node at the specified index.
+             * Returns the height of the tree, which is the number of levels in the tree.
              * 
              * @implSpec
-             * Creates a level-by-level iterator using #iterator() and iterates through the nodes
-             * until the specified index has been reached and the value of the node is returned.
-             * This implementation ignores duplicate values and treats duplicate values as a single
-             * node/iteration.
+             * If the tree is balanced using AVLBalance, iterates through the nodes starting from the root,
+             * following the taller child of each node as indicated by its balance, which takes O(log(n)) time.
+             * Otherwise, or if balancing was deferred by relaxed balancing, delegates to #shape(), which 
+             * takes O(n) time.
              * 
-             * @param index the index of the node
-             * @throws invalid_argument if the specified inex if less than 0 or greater than the number of nodes
-             * @return the value of the node at the specified index
+             * @return the height of the tree, or 0 if the tree is empty
              */
-            T operator[](int index);
+            int height();
             
             /**
-             * Displays the tree using the specified ostream.
+             * Returns the shape of the tree.
              * 
-             * @param stream the ostream used to display the tree
-             * @param the tree to display
-             * @return the ostream
+             * @implSpec
+             * Iterates through the nodes in a single pass, using a stack of the nodes and their depths
+             * which are yet to be visited.
+             * 
+             * @return the shape of the tree
              */
-            template <class V>
-            friend ostream& operator<<(ostream& stream, const AVLTree<V>& tree);
+            Shape shape();
             
             /**
-             * Returns the number of nodes in the tree.
+             * Returns the memory used by the tree.
              * 
-             * @return the number of nodes in the tree, excluding duplicate values
+             * @return the memory used by the tree
              */
-            int nodes();
+            Memory memory_usage();
             
             /**
-             * Returns the number of values in the tree.
+             * Enables a Bloom filter in front of the tree with the specified false positive rate, or 
+             * replaces the current filter. Lookups of values which the tree does not contain are then 
+             * mostly answered by the filter without walking the tree. The filter is kept in sync by 
+             * add and remove, and rebuilt automatically as the number of nodes grows.
              * 
-             * @return the number of values in the tree, including duplicate values
+             * The values must be hashable using std::hash.
+             * 
+             * @param rate the false positive rate, between 0 and 1 exclusive, or 1% if unspecified
+             * @throws invalid_argument if the rate is not between 0 and 1 exclusive
              */
-            int size();
-    };
-    
-    template <class T>
-    AVLTree<T>::AVLTree() {
-        root = shared_ptr<Node<T>>(nullptr);
-        values = 0;
-        total = 0;
+            void enable_filter(double rate = 0.01);
+            
+            /**
+             * Disables and frees the Bloom filter, if any.
+             */
+            void disable_filter();
+            
+            /**
+             * Enables a hash index alongside the tree, which maps each value to its node. Membership, amount,
+             * removal and the addition of duplicate values then locate the node in O(1) expected time instead
+             * of walking the tree, while the tree remains in use for ordered operations. The index is kept in
+             * sync by add and remove.
+             * 
+             * The values must be hashable using std::hash.
+             */
+            void enable_index();
+            
+            /**
+             * Disables and frees the hash index, if any.
+             */
+            void disable_index();
+            
+            /**
+             * Enables lazy removal. Removing the last occurrence of a value then leaves its node in the tree 
+             * as a tombstone with an amount of 0 in O(log(n)) time, without unlinking or rotating any nodes.
+             * Tombstones are skipped by lookups, iterators and aggregates, revived if their value is added 
+             * again, and discarded by #purge() once they outnumber the other nodes.
+             */
+            void enable_lazy_removal();
+            
+            /**
+             * Disables lazy removal, discarding all tombstones using #purge().
+             */
+            void disable_lazy_removal();
+            
+            /**
+             * Discards all tombstones left behind by lazy removal, if any.
+             * 
+             * @implSpec
+             * Lists the nodes in ascending order, detaches them from each other and rebuilds a balanced tree
+             * from the nodes which are not tombstones using #build(const vector<shared_ptr<Node<T>>>& nodes).
+             * Hence, this method takes O(n) time, which is amortized over the removals which left the tombstones.
+             */
+            void purge();
+            
+            /**
+             * Enables relaxed balancing. Adding and removing nodes then neither rotates the tree nor 
+             * updates the balances of the nodes, and runs at nearly the speed of an unbalanced binary 
+             * search tree. The balancing is deferred until #rebalance() is called. In the meantime the 
+             * height of the tree is bounded by rebuilding any subtree of m nodes which is taller than 
+             * (1 + slack) * log2(m) + 1.
+             * 
+             * @param slack the fraction by which subtrees may exceed the height of a perfectly balanced 
+             *              subtree, where a slack of 0.44 matches the worst case of AVLBalance and a slack 
+             *              of 1 matches the worst case of RedBlackBalance
+             * @throws invalid_argument if the slack is negative
+             */
+            void enable_relaxed_balance(double slack = 1);
+            
+            /**
+             * Disables relaxed balancing, balancing the tree using #rebalance().
+             */
+            void disable_relaxed_balance();
+            
+            /**
+             * Balances the tree according to the balancing policy after nodes were added or removed with
+             * relaxed balancing, if any. This method is intended to be called while the tree is idle, 
+             * such as between bursts of additions.
+             * 
+             * @implSpec
+             * Flattens the tree and rebuilds it using #build(const vector<shared_ptr<Node<T>>>& nodes),
+             * which sets the balances of the nodes according to the balancing policy, in O(n) time.
+             */
+            void rebalance();
+            
+            /**
+             * Relocates at most the specified number of nodes into a contiguous region of memory in 
+             * level-by-level order, so that lookups and iterations touch fewer cache lines and pages after
+             * many additions and removals have scattered the nodes. A compaction may be spread across
+             * several calls, between which the tree may be modified, and completes once the nodes in the
+             * tree have been relocated. Nodes which are still referenced outside of the tree, such as by 
+             * iterators, are detached and lose their values, since values are moved rather than copied so
+             * that keys which cannot be copied are supported.
+             * 
+             * @implSpec
+             * Starts a compaction, if none is in progress, by creating an Arena sized for the nodes in the
+             * tree and queuing the root. Afterwards takes nodes from the queue, relocating each node which 
+             * is still in the tree and was not already relocated using #relocate(shared_ptr<Node<T>> node)
+             * before queuing its children. Nodes which are added during a compaction, or moved below 
+             * relocated nodes by rotations, are left where they are. The arena is freed once all nodes 
+             * allocated from it have been removed.
+             * 
+             * @param budget the largest number of nodes to relocate, or all nodes if unspecified
+             * @return true if the compaction has completed; false if nodes remain to be relocated
+             */
+            bool compact(int budget = numeric_limits<int>::max());
+            
+            /**
+             * Adds a copy of the specified value. The value is only copied if a new node is created.
+             * 
+             * @param value the value to add
+             * @return this
+             */
+            AVLTree<T, Balance, Augment>& add(const T& value);
+            
+            /**
+             * Adds the specified value, moving it into a new node if the tree does not already contain it.
+             * 
+             * @param value the value to add
+             * @return this
+             */
+            AVLTree<T, Balance, Augment>& add(T&& value);
+            
+            /**
+             * Adds a value constructed from the specified arguments.
+             * 
+             * @param args the arguments used to construct the value
+             * @return this
+             */
+            template <class... Args>
+            AVLTree<T, Balance, Augment>& emplace(Args&&... args);
+            
+            /**
+             * Adds a copy of the specified value, starting the search for its position from the 
+             * specified hint instead of the root. The search takes O(log(d)) time, where d is
+             * the number of nodes between the hint and the value.
+             * 
+             * Values which are larger than or equal to the largest value in the tree are always
+             * appended in amortized O(1) time, regardless of the hint.
+             * 
+             * @param hint a node in this tree, such as the node returned by the previous addition or
+             *        an iterator, or null to start from the root
+             * @param value the value to add
+             * @return the node which contains the value, which may be used as the next hint
+             */
+            shared_ptr<Node<T>> add(shared_ptr<Node<T>> hint, const T& value);
+            
+            /**
+             * Adds the specified value, starting the search for its position from the specified hint
+             * instead of the root, and moving it into a new node if the tree does not already contain it.
+             * 
+             * @param hint a node in this tree, or null to start from the root
+             * @param value the value to add
+             * @return the node which contains the value, which may be used as the next hint
+             */
+            shared_ptr<Node<T>> add(shared_ptr<Node<T>> hint, T&& value);
+            
+            /**
+             * Replaces the values in the tree with the specified values, which must be sorted in ascending
+             * order. Equal values are added to the same node.
+             * 
+             * @implSpec
+             * Creates a node for each distinct value and builds a balanced tree from the nodes using 
+             * #build(const vector<shared_ptr<Node<T>>>& nodes), before rebuilding the hash index and 
+             * Bloom filter, if enabled. Hence, this method takes O(n) time instead of the O(n log(n)) time
+             * taken by adding the values one at a time.
+             * 
+             * @param sorted the values sorted in ascending order
+             * @throws invalid_argument if the values are not sorted in ascending order
+             */
+            void load(const vector<T>& sorted);
+            
+            /**
+             * Returns whether the tree contains the specified value. No path is displayed
+             * if the hash index is enabled or if the Bloom filter, if enabled, rules out the value.
+             * 
+             * @param value the value which the tree contains
+             * @param stream the ostream used to display the path taken, or cout if unspecified
+             * @return true if the tree contains the specified value; else false
+             */
+            bool contains(const T& value, ostream& stream = cout);
+            
+            /**
+             * Returns whether the tree contains each of the specified values, without displaying the paths taken.
+             * 
+             * @implSpec
+             * Delegates to #batch(const vector<T>& values, Function function, bool filtered), which is several 
+             * times faster than calling #contains(const T& value, ostream& stream) for each value if the tree 
+             * does not fit in the cache.
+             * 
+             * @param values the values to look up
+             * @param results the results, which are resized to the number of values, where each result is 
+             *        true if the tree contains the value at the same index; else false
+             */
+            void contains_batch(const vector<T>& values, vector<bool>& results);
+            
+            /**
+             * Returns the number of times the specified value occurs in the tree.
+             * 
+             * @param value the value
+             * @return the amount of the value, or 0 if the tree does not contain it
+             */
+            int amount(const T& value);
+            
+            /**
+             * Returns the number of times each of the specified values occurs in the tree.
+             * 
+             * @param values the values to look up
+             * @param results the results, which are resized to the number of values, where each result is 
+             *        the amount of the value at the same index, or 0 if the tree does not contain it
+             */
+            void count_batch(const vector<T>& values, vector<int>& results);
+            
+            /**
+             * Returns the node which contains the smallest value which is larger than or equal to each
+             * of the specified values.
+             * 
+             * @param values the values to look up
+             * @param results the results, which are resized to the number of values, where each result is 
+             *        the node for the value at the same index, or null if all values in the tree are smaller
+             */
+            void lower_bound_batch(const vector<T>& values, vector<shared_ptr<Node<T>>>& results);
+            
+            /**
+             * Removes the specified value.
+             * 
+             * @implSpec
+             * Locates the node which contains the value using #locate(const T& value). If the node amount is 1,
+             * delegates removal to #remove(shared_ptr<Node<T>> node), or leaves the node as a tombstone if
+             * lazy removal is enabled, else decrease the amount and return. Delegates to #purge() once the 
+             * tombstones outnumber the other nodes.
+             * 
+             * @param value the value to remove
+             * @return true if the value was successfully removed; else false
+             */
+            bool remove(const T& value);
+            
+            /**
+             * Returns the aggregate of all values in the tree.
+             * 
+             * @return the aggregate, or the identity of the augmentation if the tree is empty
+             */
+            typename Augment::type aggregate();
+            
+            /**
+             * Returns the aggregate of the values in the tree which are between the specified lower 
+             * and upper bound, inclusive.
+             * 
+             * @implSpec
+             * Iterates through the nodes starting from the root until a node within the bounds is found.
+             * Afterwards iterates through the left subtree of the node towards the lower bound, combining the 
+             * aggregates of the right subtrees of the nodes within the bounds, before doing the same for the right 
+             * subtree towards the upper bound. Hence, this method takes O(log(n)) time.
+             * 
+             * @param lower the lower bound
+             * @param upper the upper bound
+             * @return the aggregate, or the identity of the augmentation if no values are within the bounds
+             */
+            typename Augment::type aggregate(const T& lower, const T& upper);
+            
+            /**
+             * Returns the value at the specified index in ascending order, including duplicate values.
+             * The tree must be augmented with Count.
+             * 
+             * @implSpec
+             * Iterates through the nodes starting from the root, using the number of values in the left
+             * subtree of each node to determine whether the value is in the left subtree, the node itself
+             * or the right subtree. Hence, this method takes O(log(n)) time.
+             * 
+             * @param index the index of the value, between 0 and size() - 1
+             * @throws invalid_argument if the specified index is less than 0 or greater than or equal to the number of values
+             * @return the value at the specified index
+             */
+            const T& select(long long index);
+            
+            /**
+             * Returns an iterator with the specified traversal type for the elements in the tree.
+             * 
+             * @param traversal the traversal type, or level-by-level if unspecified
+             * @throws invalid_argument if the traversal type is unsupported
+             * @return the iterator
+             */
+            shared_ptr<Iterator<T>> iterator(Traversal traversal = Traversal::LEVEL);
+            
+            /**
+             * Calls the specified function with the value and amount of each node on the threads of the 
+             * specified pool. The function is called concurrently and in no particular order, although the
+             * nodes of each task are visited in ascending order. The tree must not be modified meanwhile.
+             *
+             * @implSpec
+             * Splits the tree by subtrees into about 8 tasks per thread of the pool.
+             *
+             * @param function the function to call with each value and amount
+             * @param pool the pool, or the shared pool if unspecified
+             */
+            template <class Function>
+            void parallel_for_each(Function function, ThreadPool& pool = ThreadPool::shared()) const;
+            
+            /**
+             * Maps the value and amount of each node to a result and combines the results on the threads of 
+             * the specified pool. The tree must not be modified meanwhile.
+             *
+             * If ordered, results are only combined with the results of adjacent values, with the smaller 
+             * values on the left, so that the combined result is deterministic and the combine function only 
+             * needs to be associative. Otherwise, the results of each task are combined in the order in which
+             * the tasks complete, without waiting for adjacent tasks, and the combine function must also be 
+             * commutative.
+             *
+             * @implSpec
+             * Splits the tree by subtrees into about 8 tasks per thread of the pool.
+             *
+             * @param identity the result of an empty tree, which does not change results it is combined with
+             * @param map the function which maps the value and amount of a node to a result
+             * @param combine the function which combines two results
+             * @param ordered whether results are combined in ascending order; true if unspecified
+             * @param pool the pool, or the shared pool if unspecified
+             * @return the combined result
+             */
+            template <class R, class Map, class Combine>
+            R parallel_reduce(R identity, Map map, Combine combine, bool ordered = true, ThreadPool& pool = ThreadPool::shared()) const;
+            
+            /**
+             * Returns the value of the node at the specified index.
+             * 
+             * @implSpec
+             * Lists the nodes level-by-level in an array when first called after the tree has been modified,
+             * and returns the value of the node at the specified index in the array. The array is discarded
+             * whenever a node is added, removed, rotated, left as a tombstone or revived, but not when only 
+             * the amount of a node otherwise changes.
+             * Hence, the first call after a modification takes O(n) time and subsequent calls take O(1) time.
+             * This implementation ignores duplicate values and treats duplicate values as a single
+             * node/iteration.
+             * 
+             * @param index the index of the node
+             * @throws invalid_argument if the specified inex if less than 0 or greater than the number of nodes
+             * @return the value of the node at the specified index
+             */
+            const T& operator[](int index);
+            
+            /**
+             * Displays the tree using the specified ostream.
+             * 
+             * @param stream the ostream used to display the tree
+             * @param the tree to display
+             * @return the ostream
+             */
+            template <class V, class B, class A>
+            friend ostream& operator<<(ostream& stream, const AVLTree<V, B, A>& tree);
+            
+            /**
+             * Returns the number of nodes in the tree.
+             * 
+             * @return the number of nodes in the tree, excluding duplicate values and tombstones
+             */
+            int nodes();
+            
+            /**
+             * Returns the number of values in the tree.
+             * 
+             * @return the number of values in the tree, including duplicate values
+             */
+            int size();
+    };
+    
+    template <class T, class Balance, class Augment>
+    AVLTree<T, Balance, Augment>::AVLTree() {
+        root = shared_ptr<Node<T>>(nullptr);
+        rightmost = shared_ptr<Node<T>>(nullptr);
+        values = 0;
+        total = 0;
+        hasher = nullptr;
+        rate = 0;
+        stale = 0;
+        lazy = false;
+        tombstones = 0;
+        relaxed = false;
+        deferred = false;
+        slack = 0;
+        peak = 0;
+        arena = nullptr;
+    }
+    
+    
+    template <class T, class Balance, class Augment>
+    AVLTree<T, Balance, Augment>::AVLTree(const AVLTree<T, Balance, Augment>& other) : AVLTree() {
+        *this = other;
+    }
+    
+    template <class T, class Balance, class Augment>
+    AVLTree<T, Balance, Augment>::AVLTree(AVLTree<T, Balance, Augment>&& other) noexcept : AVLTree() {
+        *this = std::move(other);
+    }
+    
+    template <class T, class Balance, class Augment>
+    AVLTree<T, Balance, Augment>& AVLTree<T, Balance, Augment>::operator=(const AVLTree<T, Balance, Augment>& other) {
+        if (this != &other) {
+            auto copy = AVLTree::copy(other.root, nullptr);
+            clear();
+            
+            root = copy;
+            rightmost = root;
+            while (rightmost && rightmost->right) {
+                rightmost = rightmost->right;
+            }
+            values = other.values;
+            total = other.total;
+            
+            bloom = other.bloom ? unique_ptr<BloomFilter>(new BloomFilter(*other.bloom)) : nullptr;
+            hasher = other.hasher;
+            rate = other.rate;
+            stale = other.stale;
+            lazy = other.lazy;
+            tombstones = other.tombstones;
+            relaxed = other.relaxed;
+            deferred = other.deferred;
+            slack = other.slack;
+            peak = other.peak;
+            
+            table = nullptr;
+            if (other.table) {
+                reindex();
+            }
+        }
+        return *this;
+    }
+    
+    template <class T, class Balance, class Augment>
+    AVLTree<T, Balance, Augment>& AVLTree<T, Balance, Augment>::operator=(AVLTree<T, Balance, Augment>&& other) noexcept {
+        if (this != &other) {
+            clear();
+            
+            root = std::move(other.root);
+            rightmost = std::move(other.rightmost);
+            values = other.values;
+            total = other.total;
+            
+            bloom = std::move(other.bloom);
+            table = std::move(other.table);
+            hasher = other.hasher;
+            rate = other.rate;
+            stale = other.stale;
+            lazy = other.lazy;
+            tombstones = other.tombstones;
+            relaxed = other.relaxed;
+            deferred = other.deferred;
+            slack = other.slack;
+            peak = other.peak;
+            
+            other.root = nullptr;
+            other.rightmost = nullptr;
+            other.values = 0;
+            other.total = 0;
+            other.stale = 0;
+            other.tombstones = 0;
+            other.deferred = false;
+            other.peak = 0;
+            
+            arena = other.arena;
+            compacting = std::move(other.compacting);
+            other.arena = nullptr;
+            other.compacting.clear();
+        }
+        return *this;
+    }
+    
+    template <class T, class Balance, class Augment>
+    AVLTree<T, Balance, Augment> AVLTree<T, Balance, Augment>::clone(int threads) const {
+        AVLTree<T, Balance, Augment> tree;
+        tree.root = copy(root, nullptr, threads);
+        tree.rightmost = tree.root;
+        while (tree.rightmost && tree.rightmost->right) {
+            tree.rightmost = tree.rightmost->right;
+        }
+        tree.values = values;
+        tree.total = total;
+        
+        tree.bloom = bloom ? unique_ptr<BloomFilter>(new BloomFilter(*bloom)) : nullptr;
+        tree.hasher = hasher;
+        tree.rate = rate;
+        tree.stale = stale;
+        tree.lazy = lazy;
+        tree.tombstones = tombstones;
+        tree.relaxed = relaxed;
+        tree.deferred = deferred;
+        tree.slack = slack;
+        tree.peak = peak;
+        
+        if (table) {
+            tree.reindex();
+        }
+        return tree;
+    }
+    
+    template <class T, class Balance, class Augment>
+    shared_ptr<Node<T>> AVLTree<T, Balance, Augment>::duplicate(const Node<T>& node, shared_ptr<Node<T>> parent) {
+        shared_ptr<Node<T>> copy = make_shared<typename Augmentation<T, Augment>::node>(node.value, parent);
+        copy->amount = node.amount;
+        copy->balance = node.balance;
+        Augmentation<T, Augment>::copy(node, *copy);
+        return copy;
+    }
+    
+    template <class T, class Balance, class Augment>
+    shared_ptr<Node<T>> AVLTree<T, Balance, Augment>::copy(const shared_ptr<Node<T>>& source, shared_ptr<Node<T>> parent) {
+        if (!source) {
+            return nullptr;
+        }
+        
+        auto copy = duplicate(*source, parent);
+        vector<pair<Node<T>*, shared_ptr<Node<T>>>> stack;
+        stack.push_back(make_pair(source.get(), copy));
+        
+        while (!stack.empty()) {
+            auto node = stack.back().first;
+            auto target = stack.back().second;
+            stack.pop_back();
+            
+            if (node->left) {
+                target->left = duplicate(*node->left, target);
+                stack.push_back(make_pair(node->left.get(), target->left));
+            }
+            if (node->right) {
+                target->right = duplicate(*node->right, target);
+                stack.push_back(make_pair(node->right.get(), target->right));
+            }
+        }
+        
+        return copy;
+    }
+    
+    template <class T, class Balance, class Augment>
+    shared_ptr<Node<T>> AVLTree<T, Balance, Augment>::copy(const shared_ptr<Node<T>>& source, shared_ptr<Node<T>> parent, int threads) {
+        if (!source || threads <= 1) {
+            return copy(source, parent);
+        }
+        
+        auto copy = duplicate(*source, parent);
+        auto left = async(launch::async, [&source, &copy, threads]() {
+            return AVLTree::copy(source->left, copy, threads / 2);
+        });
+        
+        copy->right = AVLTree::copy(source->right, copy, threads - threads / 2);
+        copy->left = left.get();
+        return copy;
+    }
+    
+    template <class T, class Balance, class Augment>
+    int AVLTree<T, Balance, Augment>::levels(const ThreadPool& pool) {
+        int levels = 0;
+        for (int tasks = pool.size() * 8; tasks > 1; tasks /= 2) {
+            levels++;
+        }
+        return levels;
+    }
+    
+    template <class T, class Balance, class Augment>
+    template <class Function>
+    void AVLTree<T, Balance, Augment>::visit(const shared_ptr<Node<T>>& node, Function& function) {
+        vector<Node<T>*> stack;
+        auto current = node.get();
+        while (current || !stack.empty()) {
+            while (current) {
+                stack.push_back(current);
+                current = current->left.get();
+            }
+            
+            current = stack.back();
+            stack.pop_back();
+            if (current->amount) {
+                function(current->value, current->amount);
+            }
+            current = current->right.get();
+        }
+    }
+    
+    template <class T, class Balance, class Augment>
+    template <class Function>
+    void AVLTree<T, Balance, Augment>::split(const shared_ptr<Node<T>>& node, Function& function, ThreadPool& pool, int levels) {
+        if (!node) {
+            return;
+        
+        } else if (levels == 0) {
+            function(node, true);
+            return;
+        }
+        
+        pool.join([&node, &function, &pool, levels]() {
+            split(node->left, function, pool, levels - 1);
+            function(node, false);
+        
+        }, [&node, &function, &pool, levels]() {
+            split(node->right, function, pool, levels - 1);
+        });
+    }
+    
+    template <class T, class Balance, class Augment>
+    template <class R, class Map, class Combine>
+    R AVLTree<T, Balance, Augment>::fold(const shared_ptr<Node<T>>& node, R result, Map& map, Combine& combine) {
+        vector<Node<T>*> stack;
+        auto current = node.get();
+        while (current || !stack.empty()) {
+            while (current) {
+                stack.push_back(current);
+                current = current->left.get();
+            }
+            
+            current = stack.back();
+            stack.pop_back();
+            if (current->amount) {
+                result = combine(result, map(current->value, current->amount));
+            }
+            current = current->right.get();
+        }
+        return result;
+    }
+    
+    template <class T, class Balance, class Augment>
+    template <class R, class Map, class Combine>
+    R AVLTree<T, Balance, Augment>::fold(const shared_ptr<Node<T>>& node, const R& identity, Map& map, Combine& combine, ThreadPool& pool, int levels) {
+        if (!node || levels == 0) {
+            return fold(node, identity, map, combine);
+        }
+        
+        R left = identity;
+        R right = identity;
+        pool.join([&]() {
+            left = fold(node->left, identity, map, combine, pool, levels - 1);
+        
+        }, [&]() {
+            right = fold(node->right, identity, map, combine, pool, levels - 1);
+        });
+        
+        return node->amount ? combine(combine(left, map(node->value, node->amount)), right) : combine(left, right);
+    }
+    
+    template <class T, class Balance, class Augment>
+    template <class Function>
+    void AVLTree<T, Balance, Augment>::parallel_for_each(Function function, ThreadPool& pool) const {
+        auto task = [&function](const shared_ptr<Node<T>>& node, bool whole) {
+            if (whole) {
+                visit(node, function);
+            } else if (node->amount) {
+                function(node->value, node->amount);
+            }
+        };
+        split(root, task, pool, levels(pool));
+    }
+    
+    template <class T, class Balance, class Augment>
+    template <class R, class Map, class Combine>
+    R AVLTree<T, Balance, Augment>::parallel_reduce(R identity, Map map, Combine combine, bool ordered, ThreadPool& pool) const {
+        if (ordered) {
+            return fold(root, identity, map, combine, pool, levels(pool));
+        }
+        
+        mutex lock;
+        R result = identity;
+        auto task = [&](const shared_ptr<Node<T>>& node, bool whole) {
+            if (!whole && !node->amount) {
+                return;
+            }
+            
+            R partial = whole ? fold(node, identity, map, combine) : map(node->value, node->amount);
+            lock_guard<mutex> guard(lock);
+            result = combine(result, partial);
+        };
+        
+        split(root, task, pool, levels(pool));
+        return result;
+    }
+    
+    template <class T, class Balance, class Augment>
+    AVLTree<T, Balance, Augment>::~AVLTree() {
+        clear();
+    }
+    
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::clear() {
+        auto node = root;
+        root = nullptr;
+        rightmost = nullptr;
+        stale += values;
+        values = 0;
+        tombstones = 0;
+        deferred = false;
+        peak = 0;
+        order.clear();
+        compacting.clear();
+        if (arena) {
+            arena->release();
+            arena = nullptr;
+        }
+        if (table) {
+            table->clear();
+        }
+        total = 0;
+        
+        while (node) {
+            if (node->left) {
+                node = node->left;
+                
+            } else if (node->right) {
+                node = node->right;
+                
+            } else {
+                auto parent = node->parent;
+                node->parent = nullptr;
+                
+                if (parent) {
+                    if (parent->left == node) {
+                        parent->left = nullptr;
+                        
+                    } else {
+                        parent->right = nullptr;
+                    }
+                }
+                node = parent;
+            }
+        }
+    }
+    
+    template <class T, class Balance, class Augment>
+    int AVLTree<T, Balance, Augment>::height() {
+        return deferred ? shape().height : height(static_cast<Balance*>(nullptr));
+    }
+    
+    template <class T, class Balance, class Augment>
+    int AVLTree<T, Balance, Augment>::height(AVLBalance*) {
+        int height = 0;
+        for (auto node = root.get(); node; height++) {
+            node = (node->balance < 0) ? node->left.get() : node->right.get();
+        }
+        return height;
+    }
+    
+    template <class T, class Balance, class Augment>
+    template <class B>
+    int AVLTree<T, Balance, Augment>::height(B*) {
+        return shape().height;
+    }
+    
+    template <class T, class Balance, class Augment>
+    Shape AVLTree<T, Balance, Augment>::shape() {
+        Shape shape;
+        shape.leaves = 0;
+        
+        long long depths = 0;
+        vector<pair<Node<T>*, int>> stack;
+        if (root) {
+            stack.push_back(make_pair(root.get(), 0));
+        }
+        
+        while (!stack.empty()) {
+            auto node = stack.back().first;
+            auto depth = stack.back().second;
+            stack.pop_back();
+            
+            if (depth == (int) shape.depths.size()) {
+                shape.depths.push_back(0);
+            }
+            shape.depths[depth]++;
+            shape.balances[node->balance]++;
+            shape.amounts[node->amount]++;
+            depths += depth;
+            
+            if (node->right) {
+                stack.push_back(make_pair(node->right.get(), depth + 1));
+            }
+            if (node->left) {
+                stack.push_back(make_pair(node->left.get(), depth + 1));
+            }
+            if (!node->left && !node->right) {
+                shape.leaves++;
+            }
+        }
+        
+        shape.height = shape.depths.size();
+        shape.maximumDepth = shape.height - 1;
+        shape.averageDepth = values > 0 ? (double) depths / values : 0;
+        shape.duplicates = total > 0 ? (double) (total - values) / total : 0;
+        return shape;
+    }
+    
+    template <class T, class Balance, class Augment>
+    Memory AVLTree<T, Balance, Augment>::memory_usage() {
+        auto node = sizeof(typename Augmentation<T, Augment>::node);
+        auto queue = sizeof(QueueNode<shared_ptr<Node<T>>>);
+        size_t width = (values + 1) / 2;
+        
+        Memory memory;
+        memory.nodes = values * node;
+        memory.overhead = values * overhead(node);
+        memory.scratch = width * (queue + sizeof(size_t));
+        memory.indexes = (bloom ? bloom->memory() : 0) + (table ? table->memory() : 0) + order.capacity() * sizeof(Node<T>*);
+        return memory;
+    }
+    
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::enable_filter(double rate) {
+        if (!(0 < rate && rate < 1)) {
+            throw invalid_argument("False positive rate must be between 0 and 1");
+        }
+        
+        this->rate = rate;
+        hasher = &digest<T>;
+        rebuild();
+    }
+    
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::disable_filter() {
+        bloom = nullptr;
+        stale = 0;
+    }
+    
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::enable_index() {
+        hasher = &digest<T>;
+        reindex();
+    }
+    
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::disable_index() {
+        table = nullptr;
+    }
+
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::enable_lazy_removal() {
+        lazy = true;
+    }
+    
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::disable_lazy_removal() {
+        lazy = false;
+        purge();
+    }
+    
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::purge() {
+        if (!tombstones) {
+            return;
+        }
+        
+        vector<shared_ptr<Node<T>>> all;
+        vector<shared_ptr<Node<T>>> nodes;
+        vector<shared_ptr<Node<T>>> removed;
+        all.reserve(values);
+        nodes.reserve(values - tombstones);
+        removed.reserve(tombstones);
+        
+        flatten(root, all);
+        for (auto& node : all) {
+            (node->amount ? nodes : removed).push_back(node);
+        }
+        
+        root = build(nodes);
+        rightmost = nodes.empty() ? nullptr : nodes.back();
+        values = nodes.size();
+        tombstones = 0;
+        deferred = false;
+        peak = values;
+        order.clear();
+        
+        for (auto& node : removed) {
+            untrack(node.get());
+        }
+    }
+    
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::enable_relaxed_balance(double slack) {
+        if (!(slack >= 0)) {
+            throw invalid_argument("Slack must not be negative");
+        }
+        
+        relaxed = true;
+        this->slack = slack;
+        peak = values;
+    }
+
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::disable_relaxed_balance() {
+        relaxed = false;
+        rebalance();
+    }
+
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::rebalance() {
+        if (!deferred) {
+            return;
+        }
+        
+        vector<shared_ptr<Node<T>>> nodes;
+        nodes.reserve(values);
+        flatten(root, nodes);
+        
+        root = build(nodes);
+        deferred = false;
+        peak = values;
+        order.clear();
+    }
+
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::flatten(shared_ptr<Node<T>> node, vector<shared_ptr<Node<T>>>& nodes) {
+        auto from = nodes.size();
+        vector<shared_ptr<Node<T>>> stack;
+        while (node || !stack.empty()) {
+            if (node) {
+                stack.push_back(node);
+                node = node->left;
+            
+            } else {
+                node = stack.back();
+                stack.pop_back();
+                nodes.push_back(node);
+                node = node->right;
+            }
+        }
+        
+        for (auto i = from; i < nodes.size(); i++) {
+            nodes[i]->parent = nullptr;
+            nodes[i]->left = nullptr;
+            nodes[i]->right = nullptr;
+        }
+    }
+
+    template <class T, class Balance, class Augment>
+    int AVLTree<T, Balance, Augment>::count(Node<T>* node) {
+        int count = 0;
+        vector<Node<T>*> stack;
+        if (node) {
+            stack.push_back(node);
+        }
+        
+        while (!stack.empty()) {
+            node = stack.back();
+            stack.pop_back();
+            count++;
+            
+            if (node->left) {
+                stack.push_back(node->left.get());
+            }
+            if (node->right) {
+                stack.push_back(node->right.get());
+            }
+        }
+        return count;
+    }
+
+    template <class T, class Balance, class Augment>
+    int AVLTree<T, Balance, Augment>::limit(int size) const {
+        return (int) ((1 + slack) * log2((double) size)) + 1;
+    }
+
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::bound(shared_ptr<Node<T>> node) {
+        peak = max(peak, values);
+        
+        int depth = 0;
+        for (auto parent = node->parent.get(); parent; parent = parent->parent.get()) {
+            depth++;
+        }
+        
+        if (depth < limit(values)) {
+            return;
+        }
+        
+        int size = 1;
+        int height = 1;
+        for (auto parent = node->parent; parent; node = parent, parent = parent->parent) {
+            auto sibling = parent->left == node ? parent->right : parent->left;
+            size += 1 + count(sibling.get());
+            height++;
+            
+            if (height > limit(size)) {
+                reshape(parent);
+                return;
+            }
+        }
+    }
+
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::reshape(shared_ptr<Node<T>> node) {
+        auto parent = node->parent;
+        bool left = parent && parent->left == node;
+        
+        vector<shared_ptr<Node<T>>> nodes;
+        flatten(node, nodes);
+        
+        auto subtree = build(nodes);
+        subtree->parent = parent;
+        if (!parent) {
+            root = subtree;
+        
+        } else if (left) {
+            parent->left = subtree;
+        
+        } else {
+            parent->right = subtree;
+        }
+        
+        update(parent);
+        order.clear();
+    }
+
+    template <class T, class Balance, class Augment>
+    bool AVLTree<T, Balance, Augment>::compact(int budget) {
+        if (!arena) {
+            if (!root) {
+                return true;
+            }
+            arena = new Arena(values * (sizeof(typename Augmentation<T, Augment>::node) + 4 * sizeof(void*)));
+            compacting.push_back(root);
+        }
+        
+        for (int relocated = 0; relocated < budget && !compacting.empty();) {
+            auto node = compacting.front();
+            compacting.pop_front();
+            
+            auto& parent = node->parent;
+            if (!(parent ? parent->left == node || parent->right == node : root == node) || arena->contains(node.get())) {
+                continue;
+            }
+            
+            node = relocate(node);
+            if (node->left) {
+                compacting.push_back(node->left);
+            }
+            if (node->right) {
+                compacting.push_back(node->right);
+            }
+            relocated++;
+        }
+        order.clear();
+        
+        if (compacting.empty()) {
+            arena->release();
+            arena = nullptr;
+            return true;
+        }
+        return false;
+    }
+
+    template <class T, class Balance, class Augment>
+    shared_ptr<Node<T>> AVLTree<T, Balance, Augment>::relocate(shared_ptr<Node<T>> node) {
+        using Type = typename Augmentation<T, Augment>::node;
+        uint64_t digest = table ? hasher(node->value) : 0;
+        shared_ptr<Node<T>> copy = allocate_shared<Type>(ArenaAllocator<Type>(arena), std::move(node->value), node->parent);
+        copy->amount = node->amount;
+        copy->balance = node->balance;
+        Augmentation<T, Augment>::copy(*node, *copy);
+        
+        copy->left = node->left;
+        copy->right = node->right;
+        if (copy->left) {
+            copy->left->parent = copy;
+        }
+        if (copy->right) {
+            copy->right->parent = copy;
+        }
+        relink(node, copy);
+        
+        if (node == rightmost) {
+            rightmost = copy;
+        }
+        if (table) {
+            table->remove(node.get(), digest);
+            table->add(copy.get(), digest);
+        }
+        
+        node->parent = nullptr;
+        node->left = nullptr;
+        node->right = nullptr;
+        return copy;
+    }
+
+    template <class T, class Balance, class Augment>
+    shared_ptr<Node<T>> AVLTree<T, Balance, Augment>::build(const vector<shared_ptr<Node<T>>>& nodes, int from, int to, int depth, int levels, int& height) {
+        if (from >= to) {
+            height = 0;
+            return nullptr;
+        }
+        
+        int middle = from + (to - from) / 2;
+        int left = 0;
+        int right = 0;
+        auto& node = nodes[middle];
+        
+        node->left = build(nodes, from, middle, depth + 1, levels, left);
+        node->right = build(nodes, middle + 1, to, depth + 1, levels, right);
+        if (node->left) {
+            node->left->parent = node;
+        }
+        if (node->right) {
+            node->right->parent = node;
+        }
+        
+        Balance::built(*node, left, right, depth, levels);
+        Augmentation<T, Augment>::update(node);
+        height = max(left, right) + 1;
+        return node;
+    }
+    
+    template <class T, class Balance, class Augment>
+    shared_ptr<Node<T>> AVLTree<T, Balance, Augment>::build(const vector<shared_ptr<Node<T>>>& nodes) {
+        int levels = 0;
+        for (auto size = nodes.size(); size > 0; size /= 2) {
+            levels++;
+        }
+        
+        int height = 0;
+        return build(nodes, 0, nodes.size(), 0, levels, height);
+    }
+
+    template <class T, class Balance, class Augment>
+    shared_ptr<Node<T>> AVLTree<T, Balance, Augment>::successor(shared_ptr<Node<T>> node) {
+        if (node->right) {
+            node = node->right;
+            while (node->left) {
+                node = node->left;
+            }
+            return node;
+        }
+        
+        while (node->parent && node->parent->right == node) {
+            node = node->parent;
+        }
+        return node->parent;
+    }
+    
+    template <class T, class Balance, class Augment>
+    bool AVLTree<T, Balance, Augment>::absent(const T& value) {
+        return bloom && !bloom->contains(hasher(value));
+    }
+    
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::track(const shared_ptr<Node<T>>& node) {
+        if (!bloom && !table) {
+            return;
+        }
+        
+        auto digest = hasher(node->value);
+        if (table) {
+            table->add(node.get(), digest);
+        }
+        
+        if (!bloom) {
+            return;
+            
+        } else if ((size_t) values > bloom->capacity() || (size_t) stale > bloom->capacity() / 2) {
+            rebuild();
+            
+        } else {
+            bloom->add(digest);
+        }
+    }
+    
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::untrack(Node<T>* node) {
+        if (table) {
+            table->remove(node, hasher(node->value));
+        }
+        if (bloom && (size_t) ++stale > bloom->capacity() / 2) {
+            rebuild();
+        }
+    }
+    
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::rebuild() {
+        bloom = unique_ptr<BloomFilter>(new BloomFilter(values < FILTER / 2 ? FILTER : 2 * (size_t) values, rate));
+        stale = 0;
+        each([this](Node<T>* node) {
+            bloom->add(hasher(node->value));
+        });
+    }
+    
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::reindex() {
+        table = unique_ptr<HashIndex<T>>(new HashIndex<T>(values));
+        each([this](Node<T>* node) {
+            table->add(node, hasher(node->value));
+        });
+    }
+    
+    template <class T, class Balance, class Augment>
+    template <class Function>
+    void AVLTree<T, Balance, Augment>::each(Function function) {
+        vector<Node<T>*> stack;
+        if (root) {
+            stack.push_back(root.get());
+        }
+        
+        while (!stack.empty()) {
+            auto node = stack.back();
+            stack.pop_back();
+            
+            function(node);
+            if (node->left) {
+                stack.push_back(node->left.get());
+            }
+            if (node->right) {
+                stack.push_back(node->right.get());
+            }
+        }
+    }
+    
+    template <class T, class Balance, class Augment>
+    size_t AVLTree<T, Balance, Augment>::overhead(size_t bytes) {
+        auto alignment = alignof(max_align_t);
+        auto counts = sizeof(void*) + 2 * sizeof(int);
+        auto chunk = (counts + bytes + sizeof(size_t) + alignment - 1) / alignment * alignment;
+        return chunk - bytes;
+    }
+    
+    
+    template <class T, class Balance, class Augment>
+    AVLTree<T, Balance, Augment>& AVLTree<T, Balance, Augment>::add(const T& value) {
+        insert(value, nullptr);
+        return *this;
+    }
+    
+    template <class T, class Balance, class Augment>
+    AVLTree<T, Balance, Augment>& AVLTree<T, Balance, Augment>::add(T&& value) {
+        insert(std::move(value), nullptr);
+        return *this;
+    }
+    
+    template <class T, class Balance, class Augment>
+    template <class... Args>
+    AVLTree<T, Balance, Augment>& AVLTree<T, Balance, Augment>::emplace(Args&&... args) {
+        insert(T(std::forward<Args>(args)...), nullptr);
+        return *this;
+    }
+    
+    template <class T, class Balance, class Augment>
+    shared_ptr<Node<T>> AVLTree<T, Balance, Augment>::add(shared_ptr<Node<T>> hint, const T& value) {
+        return insert(value, hint);
+    }
+    
+    template <class T, class Balance, class Augment>
+    shared_ptr<Node<T>> AVLTree<T, Balance, Augment>::add(shared_ptr<Node<T>> hint, T&& value) {
+        return insert(std::move(value), hint);
+    }
+    
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::load(const vector<T>& sorted) {
+        for (size_t i = 1; i < sorted.size(); i++) {
+            if (sorted[i] < sorted[i - 1]) {
+                throw invalid_argument("Values must be sorted in ascending order");
+            }
+        }
+        
+        clear();
+        vector<shared_ptr<Node<T>>> nodes;
+        for (auto& value : sorted) {
+            if (!nodes.empty() && !(nodes.back()->value < value)) {
+                nodes.back()->amount++;
+            
+            } else {
+                nodes.push_back(make_shared<typename Augmentation<T, Augment>::node>(value));
+            }
+        }
+        
+        root = build(nodes);
+        rightmost = nodes.empty() ? nullptr : nodes.back();
+        values = nodes.size();
+        total = sorted.size();
+        peak = values;
+        
+        if (table) {
+            reindex();
+        }
+        if (bloom) {
+            rebuild();
+        }
     }
-    
-    
-    template <class T>
-    AVLTree<T>& AVLTree<T>::add(T value) {
+
+    template <class T, class Balance, class Augment>
+    template <class V>
+    shared_ptr<Node<T>> AVLTree<T, Balance, Augment>::insert(V&& value, shared_ptr<Node<T>> hint) {
         if (!root) {
-            root = make_shared<Node<T>>(value);
+            root = make_shared<typename Augmentation<T, Augment>::node>(std::forward<V>(value));
+            rightmost = root;
+            update(root);
+            Balance::added(*this, root);
+            order.clear();
             values++;
             total++;
-            return *this;
+            track(root);
+            return root;
         }
         
-        auto node = root;
+        if (table) {
+            auto found = table->find(value, hasher(value));
+            if (found) {
+                if (found->amount++ == 0) {
+                    tombstones--;
+                    order.clear();
+                }
+                total++;
+                update(owner(found));
+                return owner(found);
+            }
+        }
+        
+        auto node = start(value, hint);
         while (node) {
             if (node->value < value) {
-                node = add(value, node, node->right, 1);
+                if (!node->right) {
+                    return add(std::forward<V>(value), node, node->right);
+                }
+                node = node->right;
                 
             } else if (node->value > value) {
-                node = add(value, node, node->left, -1);
+                if (!node->left) {
+                    return add(std::forward<V>(value), node, node->left);
+                }
+                node = node->left;
                 
             } else {
-                node->amount++;
+                if (node->amount++ == 0) {
+                    tombstones--;
+                    order.clear();
+                }
                 total++;
-                return *this;
+                update(node);
+                return node;
             }
         }
         
-        return *this;
+        return node;
     }
     
-    template <class T>
-    shared_ptr<Node<T>> AVLTree<T>::add(T value, shared_ptr<Node<T>> node, shared_ptr<Node<T>>& child, int balance) {
-        if (!child) {
-            child = make_shared<Node<T>>(value, node);
-            balanceAddition(node, balance);
-            values++;
-            total++;
-            return nullptr;
+    template <class T, class Balance, class Augment>
+    shared_ptr<Node<T>> AVLTree<T, Balance, Augment>::start(const T& value, shared_ptr<Node<T>> hint) {
+        if (!(value < rightmost->value)) {
+            return rightmost;
             
-        } else {
-            return child;
+        } else if (!hint) {
+            return root;
         }
-    }
-    
-    template <class T>
-    void AVLTree<T>::balanceAddition(shared_ptr<Node<T>> node, int balance) {
-        while (node) {
-            balance = (node->balance += balance);
-
-            if (balance == 0) {
-                return;
-                
-            } else if (balance == -2) {
-                if (node->left->balance == -1) {
-                    rotateRight(node);
-
-                } else {
-                    rotateLeftRight(node);
-                }
-                return;
-                
-            } else if (balance == 2) {
-                if (node->right->balance == 1) {
-                    rotateLeft(node);
-                    
-                } else {
-                    rotateRightLeft(node);
+        
+        auto node = hint;
+        if (node->value < value) {
+            while (node->parent) {
+                auto parent = node->parent;
+                if (parent->left == node && value < parent->value) {
+                    break;
                 }
-                return;
+                node = parent;
             }
             
-            auto parent = node->parent;
-            if (parent) {
-                if (parent->left == node) {
-                    balance = -1;
-                    
-                } else {
-                    balance = 1;
+        } else if (value < node->value) {
+            while (node->parent) {
+                auto parent = node->parent;
+                if (parent->right == node && parent->value < value) {
+                    break;
                 }
+                node = parent;
             }
-            node = parent;
         }
+        
+        return node;
+    }
+    
+    template <class T, class Balance, class Augment>
+    template <class V>
+    shared_ptr<Node<T>> AVLTree<T, Balance, Augment>::add(V&& value, shared_ptr<Node<T>> node, shared_ptr<Node<T>>& child) {
+        child = make_shared<typename Augmentation<T, Augment>::node>(std::forward<V>(value), node);
+        auto added = child;
+        if (node == rightmost && node->right == added) {
+            rightmost = added;
+        }
+        
+        update(added);
+        if (!relaxed) {
+            Balance::added(*this, added);
+        }
+        order.clear();
+        values++;
+        total++;
+        track(added);
+        
+        if (relaxed) {
+            deferred = true;
+            bound(added);
+        }
+        return added;
     }
     
     
-    template <class T>
-    bool AVLTree<T>::contains(T value, ostream& stream) {
+    template <class T, class Balance, class Augment>
+    bool AVLTree<T, Balance, Augment>::contains(const T& value, ostream& stream) {
+        if (table) {
+            auto node = table->find(value, hasher(value));
+            return node && node->amount > 0;
+            
+        } else if (absent(value)) {
+            return false;
+        }
+        
         auto node = root;
-        if (root && root->value) {
-            cout << "Root" << endl;
+        if (root) {
+            stream << "Root" << endl;
         }
         
         while (node) {
@@ -390,7 +2195,7 @@ namespace assignment {
                 stream << "Left" << endl;
                 
             } else {
-                return true;
+                return node->amount > 0;
             }
         }
         
@@ -398,15 +2203,156 @@ namespace assignment {
     }
     
     
-    template <class T>
-    bool AVLTree<T>::remove(T value) {
-        if (total == 1 && root->value == value) {
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::contains_batch(const vector<T>& values, vector<bool>& results) {
+        results.assign(values.size(), false);
+        batch(values, [&results](size_t index, const shared_ptr<Node<T>>& node, const shared_ptr<Node<T>>&) {
+            results[index] = node && node->amount > 0;
+        }, true);
+    }
+    
+    template <class T, class Balance, class Augment>
+    int AVLTree<T, Balance, Augment>::amount(const T& value) {
+        auto node = locate(value);
+        return node ? node->amount : 0;
+    }
+    
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::count_batch(const vector<T>& values, vector<int>& results) {
+        results.assign(values.size(), 0);
+        batch(values, [&results](size_t index, const shared_ptr<Node<T>>& node, const shared_ptr<Node<T>>&) {
+            results[index] = node ? node->amount : 0;
+        }, true);
+    }
+    
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::lower_bound_batch(const vector<T>& values, vector<shared_ptr<Node<T>>>& results) {
+        results.assign(values.size(), nullptr);
+        batch(values, [&results](size_t index, const shared_ptr<Node<T>>&, const shared_ptr<Node<T>>& lower) {
+            auto bound = lower;
+            while (bound && bound->amount == 0) {
+                bound = successor(bound);
+            }
+            results[index] = bound;
+        }, false);
+    }
+    
+    template <class T, class Balance, class Augment>
+    template <class Function>
+    void AVLTree<T, Balance, Augment>::batch(const vector<T>& values, Function function, bool filtered) {
+        static const shared_ptr<Node<T>> none;
+        
+        const shared_ptr<Node<T>>* links[BATCH];
+        const shared_ptr<Node<T>>* lowers[BATCH];
+        size_t indexes[BATCH];
+        
+        size_t next = 0;
+        auto load = [&](int i) {
+            while (next < values.size()) {
+                auto index = next++;
+                if (filtered && table) {
+                    auto node = table->find(values[index], hasher(values[index]));
+                    function(index, node ? owner(node) : none, none);
+                    continue;
+                    
+                } else if (filtered && absent(values[index])) {
+                    function(index, none, none);
+                    continue;
+                }
+                
+                links[i] = &root;
+                lowers[i] = &none;
+                indexes[i] = index;
+                return true;
+            }
+            return false;
+        };
+        
+        int flight = 0;
+        while (flight < BATCH && load(flight)) {
+            flight++;
+        }
+        
+        while (flight > 0) {
+            for (int i = 0; i < flight;) {
+                auto node = links[i]->get();
+                auto& value = values[indexes[i]];
+                
+                if (node && node->value < value) {
+                    links[i] = &node->right;
+                    
+                } else if (node && value < node->value) {
+                    lowers[i] = links[i];
+                    links[i] = &node->left;
+                    
+                } else {
+                    function(indexes[i], *links[i], node ? *links[i] : *lowers[i]);
+                    if (!load(i)) {
+                        flight--;
+                        links[i] = links[flight];
+                        lowers[i] = lowers[flight];
+                        indexes[i] = indexes[flight];
+                        continue;
+                    }
+                }
+                
+#ifdef __GNUC__
+                __builtin_prefetch(links[i]->get());
+#endif
+                i++;
+            }
+        }
+    }
+    
+    
+    template <class T, class Balance, class Augment>
+    bool AVLTree<T, Balance, Augment>::remove(const T& value) {
+        if (values == 1 && total == 1 && root->value == value) {
+            auto node = root;
             root = nullptr;
+            rightmost = nullptr;
+            order.clear();
             values--;
             total--;
+            untrack(node.get());
             return true;
         }
         
+        auto node = locate(value);
+        if (!node || node->amount == 0) {
+            return false;
+            
+        } else if (node->amount == 1 && lazy) {
+            node->amount = 0;
+            tombstones++;
+            total--;
+            update(node);
+            order.clear();
+            if (tombstones > values / 2) {
+                purge();
+            }
+            
+        } else if (node->amount == 1) {
+            remove(node);
+            
+        } else {
+            node->amount--;
+            total--;
+            update(node);
+        }
+        return true;
+    }
+    
+    template <class T, class Balance, class Augment>
+    shared_ptr<Node<T>> AVLTree<T, Balance, Augment>::locate(const T& value) {
+        if (absent(value)) {
+            return nullptr;
+            
+        } else if (table) {
+            auto node = table->find(value, hasher(value));
+            return node ? owner(node) : nullptr;
+        }
+        
         auto node = root;
         while (node) {
             if (node->value < value) {
@@ -416,154 +2362,133 @@ namespace assignment {
                 node = node->left;
                 
             } else {
-                if (node->amount == 1) {
-                    remove(node);
-                    return true;
-                    
-                } else {
-                    node->amount--;
-                    total--;
-                    return true;
-                }
+                return node;
             }
         }
         
-        return false;
+        return nullptr;
     }
     
-    template <class T>
-    void AVLTree<T>::remove(shared_ptr<Node<T>> node) {
-        auto left = node->left;
-        auto right = node->right;
-        if (left && right) {
+    template <class T, class Balance, class Augment>
+    const shared_ptr<Node<T>>& AVLTree<T, Balance, Augment>::owner(Node<T>* node) {
+        auto& parent = node->parent;
+        if (!parent) {
+            return root;
+        }
+        return parent->left.get() == node ? parent->left : parent->right;
+    }
+    
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::remove(shared_ptr<Node<T>> node) {
+        if (node->left && node->right) {
             removeMiddle(node);
             
-        } else if (left) {
-            replace(left, node);
-            balanceRemoval(node, 0);
-            
-        } else if (right) {
-            replace(right, node);
-            balanceRemoval(node, 0);
-            
         } else {
             auto parent = node->parent;
-            if (parent->left == node) {
-                parent->left = nullptr;
-                balanceRemoval(parent, 1);
-                
-            } else {
-                parent->right = nullptr;
-                balanceRemoval(parent, -1);
+            auto child = node->left ? node->left : node->right;
+            bool left = parent && parent->left == node;
+            
+            relink(node, child);
+            if (node == rightmost) {
+                rightmost = child ? child : parent;
+                while (rightmost && rightmost->right) {
+                    rightmost = rightmost->right;
+                }
+            }
+            
+            update(parent);
+            if (!relaxed) {
+                Balance::removed(*this, parent, child, left, node->balance);
             }
         }
+        order.clear();
         values--;
         total--;
+        untrack(node.get());
+        
+        if (relaxed) {
+            deferred = true;
+            if (values < peak / 2) {
+                rebalance();
+            }
+        }
     }
     
-    template <class T>
-    void AVLTree<T>::removeMiddle(shared_ptr<Node<T>> node) {
-        auto left = node->left;
-        auto right = node->right;
-        auto sucessor = right;
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::update(shared_ptr<Node<T>> node) {
+        if (is_same<Augment, NoAugment>::value) {
+            return;
+        }
+        
+        while (node) {
+            Augmentation<T, Augment>::update(node);
+            node = node->parent;
+        }
+    }
+    
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::relink(shared_ptr<Node<T>> node, shared_ptr<Node<T>> replacement) {
         auto parent = node->parent;
+        if (replacement) {
+            replacement->parent = parent;
+        }
         
-        if (sucessor->left) {
-            while (sucessor->left) {
-                sucessor = sucessor->left;
-            }
+        if (node == root) {
+            root = replacement;
             
-            auto sucessorParent = sucessor->parent;
-            auto sucessorRight = sucessor->right;
+        } else if (parent->left == node) {
+            parent->left = replacement;
             
+        } else {
+            parent->right = replacement;
+        }
+    }
+    
+    template <class T, class Balance, class Augment>
+    void AVLTree<T, Balance, Augment>::removeMiddle(shared_ptr<Node<T>> node) {
+        auto left = node->left;
+        auto right = node->right;
+        auto sucessor = right;
+        
+        while (sucessor->left) {
+            sucessor = sucessor->left;
+        }
+        
+        auto sucessorParent = sucessor->parent;
+        auto sucessorRight = sucessor->right;
+        auto balance = sucessor->balance;
+        
+        if (sucessorParent != node) {
             sucessorParent->left = sucessorRight;
             if (sucessorRight) {
                 sucessorRight->parent = sucessorParent;
             }
             
-            sucessor->parent = parent;
-            sucessor->left = left;
-            sucessor->balance = node->balance;
             sucessor->right = right;
-            
             right->parent = sucessor;
-            left->parent = sucessor;
-            
-            if (node == root) {
-                root = sucessor;
-                
-            } else if (parent->left == node) {
-                parent->left = sucessor;
-                
-            } else {
-                parent->right = sucessor;
-            }
-            
-            balanceRemoval(sucessorParent, 1);
             
         } else {
-            sucessor->parent = parent;
-            sucessor->left = left;
-            sucessor->balance = node->balance;
-            left->parent = sucessor;
-            
-            if (node == root) {
-                root = sucessor;
-                
-            } else if (parent->left == node) {
-                parent->left = sucessor;
-                
-            } else {
-                parent->right = sucessor;
-            }
-            
-            balanceRemoval(sucessor, -1);
+            sucessorParent = sucessor;
         }
-    }
-    
-    template <class T>
-    void AVLTree<T>::balanceRemoval(shared_ptr<Node<T>> node, int balance) {
-        while (node) {
-            balance = (node->balance += balance);
-            if (balance == -2) {
-                if (node->left->balance <= 0) {
-                    node = rotateRight(node);
-                    if (node->balance == 1) {
-                        return;
-                    }
-                    
-                } else {
-                    node = rotateLeftRight(node);
-                }
-                
-            } else if (balance == 2) {
-                if (node->right->balance >= 0) {
-                    node = rotateLeft(node);
-                    if (node->balance == -1) {
-                        return;
-                    }
-                    
-                } else {
-                    node = rotateRightLeft(node);
-                }
-            } else if (balance != 0) {
-                return;
-            }
-            
-            if (node->parent) {
-                balance = node->parent->left ? 1 : -1;
-            }
-            
-            node = node->parent;
+        
+        sucessor->left = left;
+        sucessor->balance = node->balance;
+        left->parent = sucessor;
+        relink(node, sucessor);
+        
+        update(sucessorParent);
+        if (!relaxed) {
+            Balance::removed(*this, sucessorParent, sucessorRight, sucessorParent != sucessor, balance);
         }
     }
     
     
-    template <class T>
-    shared_ptr<Node<T>> AVLTree<T>::rotateLeft(shared_ptr<Node<T>> node) {
+    template <class T, class Balance, class Augment>
+    shared_ptr<Node<T>> AVLTree<T, Balance, Augment>::rotateLeft(shared_ptr<Node<T>> node) {
         auto right = node->right;
         auto rightLeft = right->left;
         auto parent = node->parent;
+        order.clear();
         
         right->parent = parent;
         right->left = node;
@@ -584,17 +2509,18 @@ namespace assignment {
             parent->right = right;
         }
         
-        right->balance--;
-        node->balance = right->balance;
+        Augmentation<T, Augment>::update(node);
+        Augmentation<T, Augment>::update(right);
         
         return right;
     }
     
-    template <class T>
-    shared_ptr<Node<T>> AVLTree<T>::rotateRight(shared_ptr<Node<T>> node) {
+    template <class T, class Balance, class Augment>
+    shared_ptr<Node<T>> AVLTree<T, Balance, Augment>::rotateRight(shared_ptr<Node<T>> node) {
         auto left = node->left;
         auto leftRight = left->right;
         auto parent = node->parent;
+        order.clear();
         
         left->parent = parent;
         left->right = node;
@@ -615,118 +2541,105 @@ namespace assignment {
             parent->right = left;
         }
         
-        left->balance++;
-        node->balance = left->balance;
+        Augmentation<T, Augment>::update(node);
+        Augmentation<T, Augment>::update(left);
         
         return left;
     }
     
 
-    template <class T>
-    shared_ptr<Node<T>> AVLTree<T>::rotateLeftRight(shared_ptr<Node<T>> node) {
-        auto left = node->left;
-        auto leftRight = left->right;
-        auto parent = node->parent;
-        
-        auto leftRightRight = leftRight->right;
-        auto leftRightLeft = leftRight->left;
-        
-        leftRight->parent = parent;
-        node->left = leftRightRight;
-        left->right = leftRightLeft;
-        leftRight->left = left;
-        leftRight->right = node;
-        left->parent = leftRight;
-        node->parent = leftRight;
+    template <class T, class Balance, class Augment>
+    shared_ptr<Node<T>> AVLTree<T, Balance, Augment>::rotateLeftRight(shared_ptr<Node<T>> node) {
+        rotateLeft(node->left);
+        return rotateRight(node);
+    }
+    
+    template <class T, class Balance, class Augment>
+    shared_ptr<Node<T>> AVLTree<T, Balance, Augment>::rotateRightLeft(shared_ptr<Node<T>> node) {
+        rotateRight(node->right);
+        return rotateLeft(node);
+    }
+    
+    
+    template <class T, class Balance, class Augment>
+    typename Augment::type AVLTree<T, Balance, Augment>::aggregate() {
+        return Augmentation<T, Augment>::aggregate(root);
+    }
+    
+    template <class T, class Balance, class Augment>
+    typename Augment::type AVLTree<T, Balance, Augment>::aggregate(const T& lower, const T& upper) {
+        using Aggregate = Augmentation<T, Augment>;
         
-        if (leftRightRight) {
-            leftRightRight->parent = node;
+        auto node = root;
+        while (node) {
+            if (node->value < lower) {
+                node = node->right;
+                
+            } else if (upper < node->value) {
+                node = node->left;
+                
+            } else {
+                break;
+            }
         }
         
-        if (leftRightLeft) {
-            leftRightLeft->parent = left;
+        if (!node) {
+            return Augment::identity();
         }
         
-        if (node == root) {
-            root = leftRight;
-            
-        } else if (parent->left == node) {
-            parent->left = leftRight;
-            
-        } else {
-            parent->right = leftRight;
+        auto left = Augment::identity();
+        for (auto current = node->left; current;) {
+            if (current->value < lower) {
+                current = current->right;
+                
+            } else {
+                left = Augment::combine(Augment::combine(Aggregate::of(current), Aggregate::aggregate(current->right)), left);
+                current = current->left;
+            }
         }
         
-        if (leftRight->balance == 1) {
-            node->balance = 0;
-            left->balance = -1;
-            
-        } else if (leftRight->balance == -1) {
-            node->balance = 1;
-            left->balance = 0;
-            
-        } else {
-            node->balance = 0;
-            left->balance = 0;
+        auto right = Augment::identity();
+        for (auto current = node->right; current;) {
+            if (upper < current->value) {
+                current = current->left;
+                
+            } else {
+                right = Augment::combine(right, Augment::combine(Aggregate::aggregate(current->left), Aggregate::of(current)));
+                current = current->right;
+            }
         }
         
-        return leftRight;
+        return Augment::combine(Augment::combine(left, Aggregate::of(node)), right);
     }
     
-    template <class T>
-    shared_ptr<Node<T>> AVLTree<T>::rotateRightLeft(shared_ptr<Node<T>> node) {
-        auto right = node->right;
-        auto rightLeft = right->left;
-        auto parent = node->parent;
-        auto rightLeftLeft = rightLeft->left;
-        auto rightLeftRight = rightLeft->right;
-        
-        rightLeft->parent = parent;
-        node->right = rightLeftLeft;
-        right->left = rightLeftRight;
-        rightLeft->right = right;
-        rightLeft->left = node;
-        right->parent = rightLeft;
-        node->parent = rightLeft;
-        
-        if (rightLeftLeft) {
-            rightLeftLeft->parent = node;
-        }
-        
-        if (rightLeftRight) {
-            rightLeftRight->parent = right;
-        }
+    
+    template <class T, class Balance, class Augment>
+    const T& AVLTree<T, Balance, Augment>::select(long long index) {
+        static_assert(is_same<Augment, Count<T>>::value, "select(index) requires a tree augmented with Count");
         
-        if (node == root) {
-            root = rightLeft;
-            
-        } else if (parent->left == node) {
-            parent->left = rightLeft;
-            
-        } else {
-            parent->right= rightLeft;
+        if (index < 0 || index >= total) {
+            throw invalid_argument("index is invalid");
         }
         
-        if (rightLeft->balance == -1) {
-            node->balance = 0;
-            right->balance = 1;
-            
-        } else if (rightLeft->balance == 1) {
-            node->balance = -1;
-            right->balance = 0;
-            
-        } else {
-            node->balance = 0;
-            right->balance = 0;
+        auto node = root;
+        while (true) {
+            auto left = Augmentation<T, Augment>::aggregate(node->left);
+            if (index < left) {
+                node = node->left;
+                
+            } else if (index < left + node->amount) {
+                return node->value;
+                
+            } else {
+                index -= left + node->amount;
+                node = node->right;
+            }
         }
-        
-        rightLeft->balance = 0;
-        return rightLeft;
     }
     
     
-    template <class T>
-    shared_ptr<Iterator<T>> AVLTree<T>::iterator(Traversal traversal) {
+    template <class T, class Balance, class Augment>
+    shared_ptr<Iterator<T>> AVLTree<T, Balance, Augment>::iterator(Traversal traversal) {
         switch (traversal) {
             case Traversal::ASCENDING:
                 return shared_ptr<Iterator<T>>(new AscendingIterator<T>(root));
@@ -740,22 +2653,36 @@ namespace assignment {
     }
     
     
-    template <class T>
-    T AVLTree<T>::operator[](int index) {
-        if (index < 0 || index >= values) {
+    template <class T, class Balance, class Augment>
+    const T& AVLTree<T, Balance, Augment>::operator[](int index) {
+        if (index < 0 || index >= nodes()) {
             throw invalid_argument("index is invalid");
         }
         
-        shared_ptr<Iterator<T>> iterator = this->iterator();
-        for (int i = 0; i <= index; i++) {
-            (*iterator)++;
+        if (order.empty()) {
+            order.reserve(values);
+            order.push_back(root.get());
+            for (size_t i = 0; i < order.size(); i++) {
+                if (order[i]->left) {
+                    order.push_back(order[i]->left.get());
+                }
+                if (order[i]->right) {
+                    order.push_back(order[i]->right.get());
+                }
+            }
+            
+            if (tombstones) {
+                order.erase(remove_if(order.begin(), order.end(), [](Node<T>* node) {
+                    return node->amount == 0;
+                }), order.end());
+            }
         }
         
-        return iterator->get()->value;
+        return order[index]->value;
     }
     
-    template <class T>
-    ostream& operator<<(ostream& stream, AVLTree<T>& tree) {
+    template <class T, class Balance, class Augment>
+    ostream& operator<<(ostream& stream, AVLTree<T, Balance, Augment>& tree) {
         auto iterator = tree.iterator(Traversal::ASCENDING);
         while ((*iterator)++) {
             auto value = iterator->get();
@@ -765,16 +2692,47 @@ namespace assignment {
     }
     
 
-    template <class T>
-    int AVLTree<T>::nodes() {
-        return values;
+    template <class T, class Balance, class Augment>
+    int AVLTree<T, Balance, Augment>::nodes() {
+        return values - tombstones;
     }
 
-    template <class T>
-    int AVLTree<T>::size() {
+    template <class T, class Balance, class Augment>
+    int AVLTree<T, Balance, Augment>::size() {
         return total;
     }
     
+    
+    /**
+     * Returns an iterator which merges the values of the specified trees in ascending order without
+     * copying them. The trees must not be modified while they are merged.
+     * 
+     * @param trees the trees
+     * @param combine true if the amounts of equal values are combined; false if unspecified
+     * @return the iterator
+     */
+    template <class T, class Balance, class Augment>
+    shared_ptr<Iterator<T>> merge(const vector<AVLTree<T, Balance, Augment>*>& trees, bool combine = false) {
+        vector<shared_ptr<Iterator<T>>> iterators;
+        for (auto tree : trees) {
+            iterators.push_back(tree->iterator(Traversal::ASCENDING));
+        }
+        return shared_ptr<Iterator<T>>(new MergeIterator<T>(iterators, combine));
+    }
+    
+    
+    /**
+     * Represents a red-black tree.
+     */
+    template <class T, class Augment = NoAugment>
+    using RedBlackTree = AVLTree<T, RedBlackBalance, Augment>;
+    
+    /**
+     * Represents a weak AVL tree.
+     */
+    template <class T, class Augment = NoAugment>
+    using WAVLTree = AVLTree<T, WAVLBalance, Augment>;
+    
 }
 
 #endif /* TREE_H */
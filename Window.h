@@ -0,0 +1,199 @@
+/*
+ * The MIT License
+ *
+ * Copyright 2018 PohSeng#1.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * File:   Window.h
+ * Author: Matthias Ngeo - S10172190F
+ * Author: Francis Koh - S10172072G
+ *
+ * Created on January 27, 2018, 3:15 PM
+ */
+
+#ifndef WINDOW_H
+#define WINDOW_H
+
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "Augment.h"
+#include "Tree.h"
+
+using namespace std;
+
+namespace assignment {
+
+    /**
+     * Represents a sliding window over the most recently added samples, which may contain duplicate values.
+     * The window holds at most a fixed number of samples and, optionally, only the samples which were added
+     * within a duration of the latest time. Older samples are evicted automatically.
+     *
+     * The samples are kept in an AVL tree augmented with Count, which allows the median and other quantiles
+     * to be computed in O(log(n)), and in a fixed-size ring buffer which records the order of addition.
+     */
+    template <class T, class Balance = AVLBalance>
+    class Window {
+        private:
+            /**
+             * Represents a sample and the time at which it was added.
+             */
+            struct Sample {
+                T value;
+                long long time;
+            };
+            
+            AVLTree<T, Balance, Count<T>> tree;
+            vector<Sample> samples;
+            int head;
+            int count;
+            long long duration;
+            
+            /**
+             * Removes the oldest sample from the window.
+             */
+            void evict();
+        
+        public:
+            /**
+             * Constructs an empty Window which holds at most the specified number of samples.
+             *
+             * @param capacity the maximum number of samples
+             * @param duration the maximum age of samples, or unlimited if unspecified
+             * @throws invalid_argument if the capacity is less than 1 or the duration is less than 0
+             */
+            Window(int capacity, long long duration = numeric_limits<long long>::max());
+            
+            /**
+             * Adds the specified sample at the specified time, evicting the oldest sample if the window is full
+             * and all samples which are older than the duration of the window relative to the specified time.
+             *
+             * @param value the sample
+             * @param time the time of the sample, which must not be earlier than the previous sample, or 0 if unspecified
+             * @return this
+             */
+            Window<T, Balance>& add(const T& value, long long time = 0);
+            
+            /**
+             * Evicts all samples which are older than the duration of the window relative to the specified time.
+             *
+             * @param time the current time
+             * @return this
+             */
+            Window<T, Balance>& expire(long long time);
+            
+            /**
+             * Returns the median of the samples in the window. The lower median is returned if the
+             * window contains an even number of samples.
+             *
+             * @throws invalid_argument if the window is empty
+             * @return the median
+             */
+            const T& median();
+            
+            /**
+             * Returns the specified quantile of the samples in the window, which is the sample at
+             * index floor(q * (size() - 1)) in ascending order.
+             *
+             * @param q the quantile, between 0 and 1
+             * @throws invalid_argument if the window is empty or the quantile is not between 0 and 1
+             * @return the quantile
+             */
+            const T& quantile(double q);
+            
+            /**
+             * Returns the number of samples in the window.
+             *
+             * @return the number of samples
+             */
+            int size();
+    };
+
+    template <class T, class Balance>
+    Window<T, Balance>::Window(int capacity, long long duration) {
+        if (capacity < 1 || duration < 0) {
+            throw invalid_argument("Window capacity or duration is invalid");
+        }
+        
+        samples = vector<Sample>(capacity);
+        head = 0;
+        count = 0;
+        this->duration = duration;
+    }
+
+    template <class T, class Balance>
+    Window<T, Balance>& Window<T, Balance>::add(const T& value, long long time) {
+        expire(time);
+        if (count == (int) samples.size()) {
+            evict();
+        }
+        
+        auto& sample = samples[(head + count) % samples.size()];
+        sample.value = value;
+        sample.time = time;
+        count++;
+        
+        tree.add(value);
+        return *this;
+    }
+
+    template <class T, class Balance>
+    Window<T, Balance>& Window<T, Balance>::expire(long long time) {
+        while (count > 0 && time - samples[head].time >= duration) {
+            evict();
+        }
+        return *this;
+    }
+
+    template <class T, class Balance>
+    void Window<T, Balance>::evict() {
+        tree.remove(samples[head].value);
+        head = (head + 1) % samples.size();
+        count--;
+    }
+
+    template <class T, class Balance>
+    const T& Window<T, Balance>::median() {
+        return quantile(0.5);
+    }
+
+    template <class T, class Balance>
+    const T& Window<T, Balance>::quantile(double q) {
+        if (count == 0) {
+            throw invalid_argument("Window is empty");
+        
+        } else if (!(0 <= q && q <= 1)) {
+            throw invalid_argument("Quantile must be between 0 and 1");
+        }
+        
+        return tree.select((long long) (q * (count - 1)));
+    }
+
+    template <class T, class Balance>
+    int Window<T, Balance>::size() {
+        return count;
+    }
+
+}
+
+#endif /* WINDOW_H */
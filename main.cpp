@@ -41,6 +41,11 @@
 #include "Iterator.h"
 #include "Tree.h"
 
+#ifdef __linux__
+#include "Ingest.h"
+#include "Server.h"
+#endif
+
 using namespace assignment;
 using namespace std;
 
@@ -123,11 +128,46 @@ void initialise(AVLTree<T>& tree) {
 }
 
 /**
- * Contains the main programme loop.
+ * Contains the main programme loop. If started with "--serve <path>", serves an empty tree over
+ * the Unix-domain socket at the path instead of displaying the menu. If started with "--load <path>",
+ * populates the tree with the newline-separated integers in the file at the path instead of prompting
+ * for the sum of nodes.
  */
 int main(int argc, char** argv) {
     AVLTree<int> tree {};
+    
+#ifdef __linux__
+    if (argc == 3 && string(argv[1]) == "--serve") {
+        tree.enable_index();
+        try {
+            Server<AVLTree<int>> server(tree, argv[2]);
+            cout << "Serving on " << argv[2] << endl;
+            server.run();
+            return 0;
+            
+        } catch (exception& e) {
+            cout << e.what() << endl;
+            return 1;
+        }
+    }
+    
+    if (argc == 3 && string(argv[1]) == "--load") {
+        try {
+            ingest(tree, argv[2]);
+            cout << "Loaded " << tree.size() << " values" << endl;
+            
+        } catch (exception& e) {
+            cout << e.what() << endl;
+            return 1;
+        }
+        
+    } else {
+        initialise(tree);
+    }
+#else
     initialise(tree);
+#endif
+    
     while (true) {
         menu();
         switch (input("Please enter an option: ", "Option must be an integer between 1 and 6", [](int option){return 1 <= option && option <= 6;})) {